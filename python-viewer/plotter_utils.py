@@ -13,19 +13,32 @@ from matplotlib import pyplot as plt
 
 from util import load_raw_image, load_txt_image
 
+try:
+    # Built from sobel_software/python (python3 setup.py build_ext --inplace)
+    import sobel_native
+except ImportError:
+    sobel_native = None
+
 __all__ = ['compute_sobel', 'compare_with_software_sobel', 'compare_sobel_distributions', 'debug_sobel_output']
 
 
-def compute_sobel(image: np.ndarray) -> np.ndarray:
+def compute_sobel(image: np.ndarray, engine: str = 'auto') -> np.ndarray:
     """
     Compute Sobel edge detection on an image.
 
     Args:
         image: Input grayscale image.
+        engine: 'native' for the sobel_software Euclidean kernel (sobel_native extension),
+            'cv2' for OpenCV in float, 'auto' for native when the extension is available.
 
     Returns:
         Sobel edge magnitude image.
     """
+    if engine == 'native' or (engine == 'auto' and sobel_native is not None):
+        if sobel_native is None:
+            raise ImportError('sobel_native is not built, see sobel_software/README.md')
+        return np.asarray(sobel_native.euclidean(np.ascontiguousarray(image, dtype=np.uint8)))
+
     sobel_x = cv2.Sobel(image, cv2.CV_64F, 1, 0, ksize=3)
     sobel_y = cv2.Sobel(image, cv2.CV_64F, 0, 1, ksize=3)
     software_sobel = cv2.magnitude(sobel_x, sobel_y)
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "sobel_model.h"
+
+#define MAX_VALUES		64		// values per swept parameter
+
+typedef struct {
+	int n;
+	double v[MAX_VALUES];
+} sweep_list_t;
+
+typedef struct {
+
+	model_config_t *cfgs;
+	model_result_t *res;
+	int *status;				// model_run() result per configuration
+	int count;
+	int next;
+	pthread_mutex_t lock;
+
+} sweep_t;
+
+/*
+ * Function to parse a comma separated list of numbers ("512,1024,4096").
+ * @param arg  : The option argument.
+ * @param list : The parsed values.
+ * @return     : 0 on success, -1 on a malformed list.
+ */
+static int parse_list(const char *arg, sweep_list_t *list) {
+
+	char *end;
+
+	list->n = 0;
+
+	while (*arg && list->n < MAX_VALUES) {
+
+		list->v[list->n++] = strtod(arg, &end);
+
+		if (end == arg || (*end && *end != ',')) {
+			return -1;
+		}
+
+		arg = *end ? end + 1 : end;
+	}
+
+	return list->n > 0 && !*arg ? 0 : -1;
+}
+
+static void *sweep_worker(void *args) {
+
+	sweep_t *sweep = (sweep_t *)args;
+
+	for (;;) {
+
+		pthread_mutex_lock(&sweep->lock);
+		int i = sweep->next++;
+		pthread_mutex_unlock(&sweep->lock);
+
+		if (i >= sweep->count) {
+			return NULL;
+		}
+
+		sweep->status[i] = model_run(&sweep->cfgs[i], &sweep->res[i]);
+	}
+}
+
+static void usage(const char *app) {
+
+	printf("Usage : %s [options] \n\n", app);
+	printf("Every numeric option takes a comma separated list; all combinations are simulated. \n\n");
+	printf("  -R ROWS     : Frame rows (default 512) \n");
+	printf("  -C COLS     : Frame columns (default 512) \n");
+	printf("  -n FRAMES   : Frames streamed back to back (default 1) \n");
+	printf("  -d DEPTH    : CDC FIFO depth (default 1024) \n");
+	printf("  -s STAGES   : FIFO synchroniser stages (default 2) \n");
+	printf("  -i MHZ      : clk_int / op_aclk (default 200) \n");
+	printf("  -e MHZ      : clk_ext / s_axi_aclk (default 100) \n");
+	printf("  -k BYTES    : DMA chunk size (default 4096) \n");
+	printf("  -g CYCLES   : clk_ext cycles between MM2S transfers (default 0) \n");
+	printf("  -G CYCLES   : clk_ext cycles between S2MM transfers (default 0) \n");
+	printf("  -v PATTERN  : s_axis_tvalid pattern inside a transfer, e.g. 110 (default 1) \n");
+	printf("  -y PATTERN  : m_axis_tready pattern inside a transfer (default 1) \n");
+	printf("  -l MODE     : tlast on every transfer (chunk) or per frame (frame) (default chunk) \n");
+	printf("  -p MODE     : pipeline handshakes as in the RTL (rtl) or lossless (ideal) (default rtl) \n");
+	printf("  -j THREADS  : Worker threads (default: online CPUs) \n");
+}
+
+int main(int argc, char *argv[]) {
+
+	model_config_t base;
+	model_default_config(&base);
+
+	sweep_list_t rows = {1, {512}}, cols = {1, {512}}, frames = {1, {1}}, depth = {1, {1024}}, stages = {1, {2}};
+	sweep_list_t f_int = {1, {200}}, f_ext = {1, {100}}, chunk = {1, {4096}}, tx_gap = {1, {0}}, rx_gap = {1, {0}};
+	sweep_list_t tlast = {1, {MODEL_TLAST_CHUNK}}, pipeline = {1, {MODEL_PIPELINE_RTL}};
+
+	int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+	int opt, bad = 0;
+
+	while ((opt = getopt(argc, argv, "R:C:n:d:s:i:e:k:g:G:v:y:l:p:j:h")) != -1) {
+
+		switch (opt) {
+
+			case 'R': bad |= parse_list(optarg, &rows);   break;
+			case 'C': bad |= parse_list(optarg, &cols);   break;
+			case 'n': bad |= parse_list(optarg, &frames); break;
+			case 'd': bad |= parse_list(optarg, &depth);  break;
+			case 's': bad |= parse_list(optarg, &stages); break;
+			case 'i': bad |= parse_list(optarg, &f_int);  break;
+			case 'e': bad |= parse_list(optarg, &f_ext);  break;
+			case 'k': bad |= parse_list(optarg, &chunk);  break;
+			case 'g': bad |= parse_list(optarg, &tx_gap); break;
+			case 'G': bad |= parse_list(optarg, &rx_gap); break;
+			case 'j': threads = atoi(optarg);             break;
+
+			case 'v':
+			case 'y':
+				if (strlen(optarg) > MODEL_MAX_PATTERN || strspn(optarg, "01") != strlen(optarg)) {
+					bad = 1;
+				} else {
+					strcpy(opt == 'v' ? base.valid_pattern : base.ready_pattern, optarg);
+				}
+				break;
+
+			case 'l':
+				tlast.n = 0;
+				if (strstr(optarg, "chunk")) { tlast.v[tlast.n++] = MODEL_TLAST_CHUNK; }
+				if (strstr(optarg, "frame")) { tlast.v[tlast.n++] = MODEL_TLAST_FRAME; }
+				bad |= tlast.n == 0;
+				break;
+
+			case 'p':
+				pipeline.n = 0;
+				if (strstr(optarg, "rtl"))   { pipeline.v[pipeline.n++] = MODEL_PIPELINE_RTL; }
+				if (strstr(optarg, "ideal")) { pipeline.v[pipeline.n++] = MODEL_PIPELINE_IDEAL; }
+				bad |= pipeline.n == 0;
+				break;
+
+			default:
+				bad = 1;
+				break;
+		}
+	}
+
+	if (bad || optind != argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	sweep_list_t *lists[] = { &rows, &cols, &frames, &depth, &stages, &f_int, &f_ext, &chunk, &tx_gap, &rx_gap, &tlast, &pipeline };
+	const int n_lists = sizeof(lists) / sizeof(lists[0]);
+
+	int count = 1;
+	for (int l = 0; l < n_lists; l++) {
+		count *= lists[l]->n;
+	}
+
+	sweep_t sweep;
+
+	sweep.cfgs = (model_config_t *)malloc(count * sizeof(model_config_t));
+	sweep.res = (model_result_t *)malloc(count * sizeof(model_result_t));
+	sweep.status = (int *)malloc(count * sizeof(int));
+	sweep.count = count;
+	sweep.next = 0;
+	pthread_mutex_init(&sweep.lock, NULL);
+
+	if (!sweep.cfgs || !sweep.res || !sweep.status) {
+		printf("[ERROR] Failed to allocate %d configurations \n", count);
+		return 1;
+	}
+
+	// Cartesian product, last list varying fastest
+	for (int c = 0; c < count; c++) {
+
+		int idx[sizeof(lists) / sizeof(lists[0])];
+		int rest = c;
+
+		for (int l = n_lists - 1; l >= 0; l--) {
+			idx[l] = rest % lists[l]->n;
+			rest /= lists[l]->n;
+		}
+
+		model_config_t *cfg = &sweep.cfgs[c];
+
+		*cfg = base;
+		cfg->rows        = (int)rows.v[idx[0]];
+		cfg->columns     = (int)cols.v[idx[1]];
+		cfg->frames      = (int)frames.v[idx[2]];
+		cfg->fifo_depth  = (int)depth.v[idx[3]];
+		cfg->sync_stages = (int)stages.v[idx[4]];
+		cfg->f_int       = f_int.v[idx[5]] * 1e6;
+		cfg->f_ext       = f_ext.v[idx[6]] * 1e6;
+		cfg->chunk_size  = (int)chunk.v[idx[7]];
+		cfg->tx_gap      = (int)tx_gap.v[idx[8]];
+		cfg->rx_gap      = (int)rx_gap.v[idx[9]];
+		cfg->tlast       = (int)tlast.v[idx[10]];
+		cfg->pipeline    = (int)pipeline.v[idx[11]];
+	}
+
+	if (threads < 1) {
+		threads = 1;
+	}
+
+	pthread_t *tid = (pthread_t *)malloc(threads * sizeof(pthread_t));
+
+	for (int t = 0; t < threads; t++) {
+		pthread_create(&tid[t], NULL, sweep_worker, &sweep);
+	}
+
+	for (int t = 0; t < threads; t++) {
+		pthread_join(tid[t], NULL);
+	}
+
+	printf("rows,columns,frames,fifo_depth,sync_stages,f_int_mhz,f_ext_mhz,chunk_size,tx_gap,rx_gap,tlast,pipeline,"
+	       "hung,int_cycles,ext_cycles,time_us,clock_count,input_count,output_count,produced,fill_latency,"
+	       "in_fifo_max,out_fifo_max,tx_stall,out_stall,rx_starve,window_stall,window_drops,kernel_dups,kernel_drops,rx_short\n");
+
+	int failed = 0;
+
+	for (int c = 0; c < count; c++) {
+
+		const model_config_t *cfg = &sweep.cfgs[c];
+		const model_result_t *r = &sweep.res[c];
+
+		// A configuration the model rejects has no result; keep its zeros out of the CSV
+		if (sweep.status[c] != 0) {
+			fprintf(stderr, "[ERROR] Skipped rows=%d columns=%d frames=%d fifo_depth=%d chunk_size=%d: invalid configuration or out of memory \n",
+			        cfg->rows, cfg->columns, cfg->frames, cfg->fifo_depth, cfg->chunk_size);
+			failed++;
+			continue;
+		}
+
+		printf("%d,%d,%d,%d,%d,%.3f,%.3f,%d,%d,%d,%s,%s,", cfg->rows, cfg->columns, cfg->frames, cfg->fifo_depth, cfg->sync_stages,
+		       cfg->f_int / 1e6, cfg->f_ext / 1e6, cfg->chunk_size, cfg->tx_gap, cfg->rx_gap,
+		       cfg->tlast == MODEL_TLAST_CHUNK ? "chunk" : "frame", cfg->pipeline == MODEL_PIPELINE_RTL ? "rtl" : "ideal");
+
+		printf("%d,%llu,%llu,%.3f,%llu,%llu,%llu,%llu,%llu,%d,%d,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%llu\n",
+		       r->hung, (unsigned long long)r->int_cycles, (unsigned long long)r->ext_cycles, r->time_us,
+		       (unsigned long long)r->clock_count, (unsigned long long)r->in_pixels, (unsigned long long)r->out_pixels,
+		       (unsigned long long)r->produced, (unsigned long long)r->fill_latency, r->in_fifo_max, r->out_fifo_max,
+		       (unsigned long long)r->tx_stall, (unsigned long long)r->out_stall, (unsigned long long)r->rx_starve,
+		       (unsigned long long)r->window_stall, (unsigned long long)r->window_drops, (unsigned long long)r->kernel_dups,
+		       (unsigned long long)r->kernel_drops, (unsigned long long)r->rx_short);
+	}
+
+	free(tid);
+	free(sweep.cfgs);
+	free(sweep.res);
+	free(sweep.status);
+
+	return failed ? 1 : 0;
+
+} /* end of main() */
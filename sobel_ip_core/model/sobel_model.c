@@ -0,0 +1,422 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "sobel_model.h"
+
+/*
+ * Transaction-level model of sobel_accelerator.vhd
+ *
+ *   DMA MM2S -> s_axis -> Input_FIFO -> scaler -> window_buffer -> kernel_application (3 stages)
+ *            -> manhattan_norm -> Output_FIFO -> m_axis -> DMA S2MM
+ *
+ * Both clock domains are stepped edge by edge on a common picosecond time base. Every stage
+ * keeps only its valid/last registers and counters (pixel values do not affect timing), and
+ * the next state is derived from the current one with the same handshake equations as the
+ * RTL. The CDC FIFOs expose a written entry to the read side, and a freed entry to the write
+ * side, only after sync_stages + 1 edges of the other clock.
+ */
+
+typedef struct {
+
+	int depth;
+	uint64_t *wtime;		// time each entry was written
+	uint64_t *ptime;		// time each entry was read
+	uint8_t *last;			// tlast of each entry
+	uint64_t wr;			// entries written
+	uint64_t rd;			// entries read
+	uint64_t rd_lat;		// write -> visible to the reader (ps)
+	uint64_t wr_lat;		// read  -> visible to the writer (ps)
+
+} model_fifo_t;
+
+static int fifo_init(model_fifo_t *f, int depth, uint64_t rd_lat, uint64_t wr_lat) {
+
+	f->depth = depth;
+	f->wtime = (uint64_t *)calloc(depth, sizeof(uint64_t));
+	f->ptime = (uint64_t *)calloc(depth, sizeof(uint64_t));
+	f->last  = (uint8_t *)calloc(depth, 1);
+	f->wr = f->rd = 0;
+	f->rd_lat = rd_lat;
+	f->wr_lat = wr_lat;
+
+	return f->wtime && f->ptime && f->last ? 0 : -1;
+}
+
+static void fifo_free(model_fifo_t *f) {
+
+	free(f->wtime);
+	free(f->ptime);
+	free(f->last);
+}
+
+static int fifo_can_read(const model_fifo_t *f, uint64_t t) {
+	return f->rd < f->wr && f->wtime[f->rd % f->depth] + f->rd_lat <= t;
+}
+
+static int fifo_can_write(const model_fifo_t *f, uint64_t t) {
+	return f->wr - f->rd < (uint64_t)f->depth && (f->wr < (uint64_t)f->depth || f->ptime[f->wr % f->depth] + f->wr_lat <= t);
+}
+
+static void fifo_push(model_fifo_t *f, uint64_t t, int last) {
+
+	f->wtime[f->wr % f->depth] = t;
+	f->last[f->wr % f->depth] = (uint8_t)last;
+	f->wr++;
+}
+
+static int fifo_pop(model_fifo_t *f, uint64_t t) {
+
+	int last = f->last[f->rd % f->depth];
+
+	f->ptime[f->rd % f->depth] = t;
+	f->rd++;
+
+	return last;
+}
+
+/*
+ * Function to fill a configuration with the parameters of the shipped design: a 512x512 frame,
+ * 200 MHz op_aclk, 100 MHz s_axi_aclk, 1024-deep FIFOs (fifo_generator_0.xci) and the 4 KiB
+ * chunks of sobel_pl.
+ * @param cfg : The configuration.
+ */
+void model_default_config(model_config_t *cfg) {
+
+	memset(cfg, 0, sizeof(*cfg));
+
+	cfg->rows = 512;
+	cfg->columns = 512;
+	cfg->frames = 1;
+	cfg->fifo_depth = 1024;
+	cfg->sync_stages = 2;
+	cfg->f_int = 200e6;
+	cfg->f_ext = 100e6;
+	cfg->chunk_size = 4096;
+	cfg->tx_gap = 0;
+	cfg->rx_gap = 0;
+	cfg->tlast = MODEL_TLAST_CHUNK;
+	cfg->pipeline = MODEL_PIPELINE_RTL;
+	strcpy(cfg->valid_pattern, "1");
+	strcpy(cfg->ready_pattern, "1");
+	cfg->idle_limit = 100000;
+
+} /* end of model_default_config() */
+
+/*
+ * Function to simulate the configured frames through the accelerator.
+ * @param cfg : The configuration.
+ * @param res : The predicted cycle counts, counters and stall points.
+ * @return    : 0 on success, -1 on an invalid configuration or allocation failure.
+ */
+int model_run(const model_config_t *cfg, model_result_t *res) {
+
+	memset(res, 0, sizeof(*res));
+
+	if (cfg->rows < 3 || cfg->columns < 3 || cfg->frames < 1 || cfg->fifo_depth < 1 || cfg->chunk_size < 1 ||
+	    cfg->f_int <= 0.0 || cfg->f_ext <= 0.0 || !cfg->valid_pattern[0] || !cfg->ready_pattern[0]) {
+		return -1;
+	}
+
+	const uint64_t T_int = (uint64_t)llround(1e12 / cfg->f_int);
+	const uint64_t T_ext = (uint64_t)llround(1e12 / cfg->f_ext);
+
+	model_fifo_t in_fifo, out_fifo;
+
+	int ok = fifo_init(&in_fifo,  cfg->fifo_depth, (cfg->sync_stages + 1) * T_int, (cfg->sync_stages + 1) * T_ext) == 0 &&
+	         fifo_init(&out_fifo, cfg->fifo_depth, (cfg->sync_stages + 1) * T_ext, (cfg->sync_stages + 1) * T_int) == 0;
+
+	if (!ok) {
+		fifo_free(&in_fifo);
+		fifo_free(&out_fifo);
+		return -1;
+	}
+
+	const int rtl = cfg->pipeline == MODEL_PIPELINE_RTL;
+	const int n_valid = (int)strlen(cfg->valid_pattern);
+	const int n_ready = (int)strlen(cfg->ready_pattern);
+
+	const uint64_t frame_in  = (uint64_t)cfg->rows * cfg->columns;
+	const uint64_t frame_out = (uint64_t)(cfg->rows - 2) * (cfg->columns - 2);
+	const uint64_t total_in  = frame_in * cfg->frames;
+	const uint64_t total_out = frame_out * cfg->frames;
+
+	// MM2S state (clk_ext)
+	uint64_t tx_sent = 0;
+	uint64_t tx_remain = 0;
+	int tx_wait = 0;
+	int tx_phase = 0;
+
+	// S2MM state (clk_ext)
+	uint64_t rx_recv = 0;
+	uint64_t rx_remain = 0;
+	int rx_wait = 0;
+	int rx_phase = 0;
+
+	// Processing core registers (clk_int)
+	int sv = 0, s_last = 0;									// scaler
+	int bv = 0, b_last = 0, row = 0, col = 0;				// window_buffer
+	int s1v = 0, s1_last = 0, s2v = 0, s2_last = 0;			// kernel_application stages 1 and 2
+	int s2_taken = 0;										// stage 2 content already copied to the output stage
+	int ov = 0, o_last = 0;									// kernel_application output stage
+
+	uint64_t t_first_in = 0, t_first_out = 0, t_end = 0;
+	uint64_t t_activity = 0;
+	uint64_t next_int = T_int, next_ext = T_ext;
+
+	while (rx_recv < total_out) {
+
+		if (next_ext <= next_int) {
+
+			uint64_t t = next_ext;
+			next_ext += T_ext;
+
+			// ---- DMA MM2S -> s_axis ----
+			if (tx_wait > 0) {
+
+				tx_wait--;
+
+			} else if (tx_remain == 0 && tx_sent < total_in) {
+
+				uint64_t left = frame_in - tx_sent % frame_in;
+				tx_remain = left < (uint64_t)cfg->chunk_size ? left : (uint64_t)cfg->chunk_size;
+			}
+
+			if (tx_wait == 0 && tx_remain > 0) {
+
+				if (cfg->valid_pattern[tx_phase++ % n_valid] == '1') {
+
+					if (fifo_can_write(&in_fifo, t)) {
+
+						int frame_end = (tx_sent + 1) % frame_in == 0;
+						int last = tx_remain == 1 && (cfg->tlast == MODEL_TLAST_CHUNK || frame_end);
+
+						if (tx_sent == 0) {
+							t_first_in = t;
+						}
+
+						fifo_push(&in_fifo, t, last);
+						tx_sent++;
+						res->in_pixels++;
+						t_activity = t;
+
+						if (--tx_remain == 0) {
+							tx_wait = cfg->tx_gap;
+						}
+
+					} else {
+
+						res->tx_stall++;
+					}
+				}
+
+				if (in_fifo.wr - in_fifo.rd > (uint64_t)res->in_fifo_max) {
+					res->in_fifo_max = (int)(in_fifo.wr - in_fifo.rd);
+				}
+			}
+
+			// ---- m_axis -> DMA S2MM ----
+			if (rx_wait > 0) {
+
+				rx_wait--;
+
+			} else if (rx_remain == 0) {
+
+				uint64_t left = frame_out - rx_recv % frame_out;
+				rx_remain = left < (uint64_t)cfg->chunk_size ? left : (uint64_t)cfg->chunk_size;
+			}
+
+			if (rx_wait == 0 && rx_remain > 0 && cfg->ready_pattern[rx_phase++ % n_ready] == '1') {
+
+				if (fifo_can_read(&out_fifo, t)) {
+
+					int last = fifo_pop(&out_fifo, t);
+
+					rx_recv++;
+					res->out_pixels++;
+					t_activity = t;
+					t_end = t;
+
+					if (--rx_remain == 0 || last) {
+
+						if (rx_remain > 0) {
+							res->rx_short++;
+						}
+
+						rx_remain = 0;
+						rx_wait = cfg->rx_gap;
+					}
+
+				} else {
+
+					res->rx_starve++;
+				}
+			}
+
+		} else {
+
+			uint64_t t = next_int;
+			next_int += T_int;
+
+			// ---- combinational handshakes of the current cycle ----
+			int in_valid  = fifo_can_read(&in_fifo, t);
+			int out_ready = fifo_can_write(&out_fifo, t);		// manhattan_norm: s_ready <= m_ready
+
+			int ready_k = rtl ? (!s1v || !s2v || (!ov && out_ready)) : (!ov || out_ready);
+			int wb_ready = ready_k || !bv;
+			int sc_ready = !sv || wb_ready;
+
+			if (t_first_in && (in_valid || sc_ready)) {
+				res->clock_count++;
+			}
+
+			// ---- manhattan_norm -> Output_FIFO ----
+			if (ov && out_ready) {
+
+				fifo_push(&out_fifo, t, o_last);
+
+				if (res->produced++ == 0) {
+					t_first_out = t;
+				}
+
+				t_activity = t;
+
+				if (out_fifo.wr - out_fifo.rd > (uint64_t)res->out_fifo_max) {
+					res->out_fifo_max = (int)(out_fifo.wr - out_fifo.rd);
+				}
+
+			} else if (ov) {
+
+				res->out_stall++;
+			}
+
+			// ---- kernel_application ----
+			int n_ov = ov, n_olast = o_last;
+			int n_s1v = s1v, n_s1last = s1_last, n_s2v = s2v, n_s2last = s2_last, n_taken = s2_taken;
+
+			if (rtl) {
+
+				int took = 0;
+
+				if (out_ready && ov) {
+					n_ov = 0;
+					n_olast = 0;
+				}
+
+				if ((out_ready || !ov) && s2v) {
+
+					if (s2_taken) {
+						res->kernel_dups++;
+					}
+
+					n_ov = 1;
+					n_olast = s2_last;
+					took = 1;
+				}
+
+				if (ready_k) {
+
+					if (s2v && !s2_taken && !took) {
+						res->kernel_drops++;
+					}
+
+					n_s1v = bv;
+					n_s1last = b_last;
+					n_s2v = s1v;
+					n_s2last = s1_last;
+					n_taken = 0;
+
+				} else {
+
+					n_taken = s2_taken || took;
+				}
+
+			} else if (ready_k) {
+
+				n_ov = s2v;
+				n_olast = s2_last;
+				n_s2v = s1v;
+				n_s2last = s1_last;
+				n_s1v = bv;
+				n_s1last = b_last;
+			}
+
+			// ---- window_buffer ----
+			int n_bv = 0, n_blast = 0;
+
+			if (bv && !ready_k) {
+
+				if (rtl) {
+					res->window_drops++;	// buf_valid is cleared whether or not the window was taken
+				} else {
+					n_bv = 1;
+					n_blast = b_last;
+				}
+			}
+
+			if (sv && !wb_ready) {
+				res->window_stall++;
+			}
+
+			if (sv && wb_ready) {
+
+				if (row >= 2 && col >= 2) {
+					n_bv = 1;
+					n_blast = row == cfg->rows - 1 && col == cfg->columns - 1;
+				}
+
+				if (col == cfg->columns - 1) {
+					col = 0;
+					row = row == cfg->rows - 1 ? 0 : row + 1;
+				} else {
+					col++;
+				}
+
+				if (s_last) {
+					row = 0;
+					col = 0;
+				}
+			}
+
+			// ---- scaler <- Input_FIFO ----
+			int n_sv = sv, n_slast = s_last;
+
+			if (wb_ready) {
+				n_sv = 0;
+				n_slast = 0;
+			}
+
+			if (in_valid && sc_ready) {
+				n_slast = fifo_pop(&in_fifo, t);
+				n_sv = 1;
+				t_activity = t;
+			}
+
+			// ---- register update ----
+			sv = n_sv;     s_last = n_slast;
+			bv = n_bv;     b_last = n_blast;
+			s1v = n_s1v;   s1_last = n_s1last;
+			s2v = n_s2v;   s2_last = n_s2last;   s2_taken = n_taken;
+			ov = n_ov;     o_last = n_olast;
+
+			// ---- hang detection: the host would time out waiting for the S2MM transfer ----
+			if (t - t_activity > cfg->idle_limit * T_int && t_first_in) {
+				res->hung = 1;
+				t_end = t_activity;
+				break;
+			}
+		}
+	}
+
+	res->int_cycles   = (t_end - t_first_in) / T_int;
+	res->ext_cycles   = (t_end - t_first_in) / T_ext;
+	res->time_us      = (t_end - t_first_in) / 1e6;
+	res->fill_latency = res->produced ? (t_first_out - t_first_in) / T_int : 0;
+
+	fifo_free(&in_fifo);
+	fifo_free(&out_fifo);
+
+	return 0;
+
+} /* end of model_run() */
@@ -0,0 +1,70 @@
+#ifndef _SOBEL_MODEL_H_
+#define _SOBEL_MODEL_H_
+
+#include <stdint.h>
+
+#define MODEL_PIPELINE_RTL		0		// handshakes exactly as written in window_buffer.vhd / kernel_application.vhd
+#define MODEL_PIPELINE_IDEAL	1		// same stages with lossless valid/ready (hold instead of drop)
+
+#define MODEL_TLAST_CHUNK		0		// AXI DMA simple mode: tlast on the last beat of every transfer
+#define MODEL_TLAST_FRAME		1		// tlast only on the last beat of every frame
+
+#define MODEL_MAX_PATTERN		64		// longest tvalid / tready pattern
+
+typedef struct {
+
+	int rows;					// Frame rows    (rows generic)
+	int columns;				// Frame columns (columns generic)
+	int frames;					// Frames streamed back to back
+
+	int fifo_depth;				// Depth of the input and output CDC FIFOs (fifo_generator_0)
+	int sync_stages;			// Synchroniser stages of the FIFO pointers
+
+	double f_int;				// clk_int (op_aclk) in Hz
+	double f_ext;				// clk_ext (s_axi_aclk) in Hz
+
+	int chunk_size;				// Bytes per DMA transfer (TX and RX), never crossing a frame
+	int tx_gap;					// clk_ext cycles between two MM2S transfers (host ioctl turnaround)
+	int rx_gap;					// clk_ext cycles between two S2MM transfers
+	int tlast;					// MODEL_TLAST_CHUNK or MODEL_TLAST_FRAME
+	int pipeline;				// MODEL_PIPELINE_RTL or MODEL_PIPELINE_IDEAL
+
+	char valid_pattern[MODEL_MAX_PATTERN + 1];	// s_axis_tvalid per clk_ext cycle inside a transfer, e.g. "1" or "110"
+	char ready_pattern[MODEL_MAX_PATTERN + 1];	// m_axis_tready per clk_ext cycle inside a transfer
+
+	uint64_t idle_limit;		// clk_int cycles without any handshake before the frame is declared hung
+
+} model_config_t;
+
+typedef struct {
+
+	int hung;					// The host would hit a DMA timeout (RX never received the expected bytes)
+
+	uint64_t int_cycles;		// clk_int cycles from the first TX beat to the last RX beat
+	uint64_t ext_cycles;		// clk_ext cycles over the same interval
+	double time_us;				// Same interval in microseconds
+	uint64_t clock_count;		// Predicted CLOCK_COUNT_REG (clk_int cycles with proc_s_valid or proc_s_ready)
+
+	uint64_t in_pixels;			// Predicted INPUT_COUNT_REG  (s_axis handshakes)
+	uint64_t out_pixels;		// Predicted OUTPUT_COUNT_REG (m_axis handshakes)
+	uint64_t produced;			// Pixels written into the output FIFO by the core
+	uint64_t fill_latency;		// clk_int cycles from the first input beat to the first output pixel
+
+	int in_fifo_max;			// Peak input FIFO occupancy (write side view)
+	int out_fifo_max;			// Peak output FIFO occupancy (write side view)
+	uint64_t tx_stall;			// clk_ext cycles s_axis_tvalid was held off by a full input FIFO
+	uint64_t out_stall;			// clk_int cycles the norm stage was held off by a full output FIFO
+	uint64_t rx_starve;			// clk_ext cycles m_axis_tready was waiting for an empty output FIFO
+	uint64_t window_stall;		// clk_int cycles the scaler output was held off by the window buffer
+	uint64_t window_drops;		// Windows discarded by window_buffer while kernel_application was not ready
+	uint64_t kernel_dups;		// Gradients emitted twice by the kernel_application output stage
+	uint64_t kernel_drops;		// Gradients overwritten in kernel_application stage 2 before being emitted
+	uint64_t rx_short;			// S2MM transfers ended early by tlast
+
+} model_result_t;
+
+void model_default_config( model_config_t *cfg );
+
+int model_run( const model_config_t *cfg, model_result_t *res );
+
+#endif // _SOBEL_MODEL_H_
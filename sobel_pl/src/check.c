@@ -0,0 +1,124 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sobel_cpu.h"
+
+/*
+ * make check : the vector CPU kernel against the SCALAR=1 build of the same source (compiled
+ * into this binary under the names below) and against a plain clamped Manhattan Sobel, on
+ * image widths around the vector length and on sub-rectangles of them, as the tiler and the
+ * hybrid split request them.
+ */
+void sobel_cpu_scalar_manhattan( const uint8_t *in, uint8_t *out, int Nx, int Ny, int x0, int y0, int x1, int y1 );
+
+static uint32_t seed = 1;
+
+static uint32_t check_rand(void) {
+
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+/*
+ * Reference output pixel (x, y): neighbours outside the image replicated from the nearest edge.
+ */
+static uint8_t check_pixel(const uint8_t *in, int Nx, int Ny, int x, int y) {
+
+    int w[3][3];
+
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int yy = y + dy < 0 ? 0 : (y + dy >= Ny ? Ny - 1 : y + dy);
+            int xx = x + dx < 0 ? 0 : (x + dx >= Nx ? Nx - 1 : x + dx);
+            w[dy + 1][dx + 1] = in[(size_t)yy * Nx + xx];
+        }
+    }
+
+    int sx = (w[0][2] - w[0][0]) + 2 * (w[1][2] - w[1][0]) + (w[2][2] - w[2][0]);
+    int sy = (w[2][0] + 2 * w[2][1] + w[2][2]) - (w[0][0] + 2 * w[0][1] + w[0][2]);
+    int magnitude = abs(sx) + abs(sy);
+
+    return magnitude > 255 ? 255 : magnitude;
+}
+
+/*
+ * Runs both kernels on the rectangle [x0, x1) x [y0, y1) of one image and compares every output
+ * pixel, inside the rectangle with the reference and outside it with the untouched fill.
+ * @return 0 if both match, 1 otherwise.
+ */
+static int check_rect(const uint8_t *in, uint8_t *vec, uint8_t *ref, int Nx, int Ny, int x0, int y0, int x1, int y1) {
+
+    size_t n = (size_t)Nx * Ny;
+
+    memset(vec, 0xa5, n);
+    memset(ref, 0xa5, n);
+
+    sobel_cpu_manhattan(in, vec, Nx, Ny, x0, y0, x1, y1);
+    sobel_cpu_scalar_manhattan(in, ref, Nx, Ny, x0, y0, x1, y1);
+
+    if (memcmp(vec, ref, n) != 0) {
+        printf("[FAIL] vector and scalar kernels differ on %d x %d, [%d, %d) x [%d, %d)\n", Nx, Ny, x0, x1, y0, y1);
+        return 1;
+    }
+
+    for (int y = y0; y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            if (ref[(size_t)y * Nx + x] != check_pixel(in, Nx, Ny, x, y)) {
+                printf("[FAIL] kernel differs from the reference on %d x %d at (%d, %d)\n", Nx, Ny, x, y);
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int main(void) {
+
+    static const int sizes[] = { 1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 64, 511, 513 };
+    int n_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    long cases = 0, failed = 0;
+
+    for (int i = 0; i < n_sizes; i++) {
+        for (int j = 0; j < n_sizes; j++) {
+
+            int Nx = sizes[i], Ny = sizes[j];
+
+            // The largest images only against narrow partners, to keep the run short
+            if (Nx > 64 && Ny > 17) continue;
+
+            uint8_t *in = malloc((size_t)Nx * Ny);
+            uint8_t *vec = malloc((size_t)Nx * Ny);
+            uint8_t *ref = malloc((size_t)Nx * Ny);
+
+            for (int pattern = 0; pattern < 2; pattern++) {
+
+                // Random pixels, then a 0/255 checkerboard that saturates the magnitude
+                for (size_t k = 0; k < (size_t)Nx * Ny; k++) {
+                    in[k] = pattern ? (((k % Nx) / 2 + (k / Nx) / 2) & 1) * 255 : (uint8_t)check_rand();
+                }
+
+                failed += check_rect(in, vec, ref, Nx, Ny, 0, 0, Nx, Ny);
+                cases++;
+
+                for (int r = 0; r < 8; r++) {
+                    int x0 = check_rand() % Nx, x1 = x0 + 1 + check_rand() % (Nx - x0);
+                    int y0 = check_rand() % Ny, y1 = y0 + 1 + check_rand() % (Ny - y0);
+
+                    failed += check_rect(in, vec, ref, Nx, Ny, x0, y0, x1, y1);
+                    cases++;
+                }
+            }
+
+            free(in);
+            free(vec);
+            free(ref);
+        }
+    }
+
+    printf("[%s] sobel_cpu: %ld cases, %ld mismatching\n", failed ? "FAIL" : " OK ", cases, failed);
+    return failed != 0;
+
+} /* end of main() */
@@ -0,0 +1,337 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <stddef.h>
+
+#include "emulator.h"
+#include "sobel_pl.h"
+#include "sobel_cpu.h"
+
+/*
+ * Software stand-in for the dma-proxy driver and the Sobel IP core, selected at build time
+ * with `make EMULATE=1`. Every emulated core streams pixels through the same window buffer,
+ * kernel and Manhattan norm arithmetic as sobel_processing_core.vhd (including the cropped
+ * and wrapped border columns) into an output FIFO that the RX channel drains. The tlast
+ * the AXI DMA asserts at the end of every MM2S transfer resets the window counters, as in
+ * window_buffer.vhd. TX transfers are paced to EMU_PIXEL_RATE so that host-side scheduling
+ * can be evaluated on a PC.
+ */
+
+#define EMU_RING_SIZE			2048						// power of two >= 2 * SOBEL_IP_CORE_COLS + 3
+#define EMU_RING_MASK			( EMU_RING_SIZE - 1 )
+#define EMU_FIFO_SIZE			( 2 * TILE_OUT_SIZE )		// outputs buffered before TX stalls
+
+typedef struct {
+
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+
+	uint32_t regs[SOBEL_IP_CORE_REG_SIZE / 4];	// AXI4-Lite register file
+
+	uint8_t ring[EMU_RING_SIZE];	// window_buffer shift register
+	uint32_t n;						// stream position
+	int row;						// window_buffer row_counter
+	int col;						// window_buffer column_counter
+
+	uint8_t fifo[EMU_FIFO_SIZE];	// processed pixels waiting for the S2MM channel
+	uint32_t head;
+	uint32_t count;
+
+} emu_core_t;
+
+static emu_core_t cores[EMU_MAX_INSTANCES];
+static pthread_once_t cores_once = PTHREAD_ONCE_INIT;
+static double pixel_rate = EMU_PIXEL_RATE;
+
+static double emu_now(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void emu_reset(emu_core_t *core) {
+
+	memset(core->regs + 1, 0, sizeof(core->regs) - sizeof(core->regs[0]));
+	memset(core->ring, 0, sizeof(core->ring));
+	core->n = EMU_RING_SIZE;
+	core->row = 0;
+	core->col = 0;
+	core->head = 0;
+	core->count = 0;
+}
+
+static void emu_init_cores(void) {
+
+	char *rate = getenv("SOBEL_EMU_RATE");
+	if (rate) {
+		pixel_rate = atof(rate);
+	}
+
+	for (int i = 0; i < EMU_MAX_INSTANCES; i++) {
+		pthread_mutex_init(&cores[i].lock, NULL);
+		pthread_cond_init(&cores[i].cond, NULL);
+		cores[i].regs[ENABLE_REG_OFFSET >> 2] = 0;
+		emu_reset(&cores[i]);
+	}
+}
+
+/*
+ * Waits on the core condition variable with the dma-proxy timeout.
+ * @return : 0 when signalled, ETIMEDOUT otherwise.
+ */
+static int emu_wait(emu_core_t *core) {
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_sec += EMU_TIMEOUT_MS / 1000;
+	ts.tv_nsec += (EMU_TIMEOUT_MS % 1000) * 1000000L;
+	if (ts.tv_nsec >= 1000000000L) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000L;
+	}
+	return pthread_cond_timedwait(&core->cond, &core->lock, &ts);
+}
+
+/*
+ * Pushes one pixel through the window buffer. The window is formed from the shift register
+ * *before* the new pixel enters it, exactly like the signal assignments in window_buffer.vhd.
+ * @param last : tlast of the pixel, which resets the row and column counters.
+ * @return     : 1 if a processed pixel was written to out, 0 otherwise.
+ */
+static inline int emu_push(emu_core_t *core, uint8_t pixel, int last, uint8_t *out) {
+
+	const int C = SOBEL_IP_CORE_COLS;
+	const uint8_t *r = core->ring;
+	uint32_t n = core->n;
+	int produced = 0;
+
+	if (core->row >= 2 && core->col >= 2) {
+
+		int t0 = r[(n - 2*C - 3) & EMU_RING_MASK], t1 = r[(n - 2*C - 2) & EMU_RING_MASK], t2 = r[(n - 2*C - 1) & EMU_RING_MASK];
+		int m0 = r[(n -   C - 3) & EMU_RING_MASK],                                        m2 = r[(n -   C - 1) & EMU_RING_MASK];
+		int b0 = r[(n -       3) & EMU_RING_MASK], b1 = r[(n -       2) & EMU_RING_MASK], b2 = r[(n -       1) & EMU_RING_MASK];
+
+		// kernel_application.vhd
+		int gx = (t2 - t0) + 2 * (m2 - m0) + (b2 - b0);
+		int gy = (t0 + 2 * t1 + t2) - (b0 + 2 * b1 + b2);
+
+		// manhattan_norm.vhd
+		int magnitude = abs(gx) + abs(gy);
+		*out = magnitude > 255 ? 255 : magnitude;
+		produced = 1;
+	}
+
+	core->ring[n & EMU_RING_MASK] = pixel;
+	core->n = n + 1;
+
+	if (last) {
+		core->col = 0;
+		core->row = 0;
+	} else if (core->col == C - 1) {
+		core->col = 0;
+		core->row = core->row == SOBEL_IP_CORE_ROWS - 1 ? 0 : core->row + 1;
+	} else {
+		core->col++;
+	}
+
+	return produced;
+}
+
+/*
+ * Pushes a whole frame that starts with the window counters at zero, the case of every tile
+ * sent by ps2pl(). Produces the same TILE_OUT_SIZE pixels as emu_push() would, output (i, j)
+ * being the window centred at frame pixel (i + 1, j), but runs the interior of every row
+ * through the CPU kernel. Column 0 takes its left neighbours from the end of the previous
+ * row, and for the first row from the pixel streamed before the frame.
+ */
+static void emu_frame(emu_core_t *core, const uint8_t *src, uint8_t *out) {
+
+	const int C = SOBEL_IP_CORE_COLS;
+	uint8_t before = core->ring[(core->n - 1) & EMU_RING_MASK];
+
+	for (int i = 0; i < TILE_OUT_ROWS; i++) {
+
+		const uint8_t *t = src + (size_t)i * C, *m = t + C, *b = m + C;
+		uint8_t *o = out + (size_t)i * TILE_OUT_COLS;
+
+		int t0 = i > 0 ? t[-1] : before, m0 = m[-1], b0 = b[-1];
+		int gx = (t[1] - t0) + 2 * (m[1] - m0) + (b[1] - b0);
+		int gy = (t0 + 2 * t[0] + t[1]) - (b0 + 2 * b[0] + b[1]);
+		int magnitude = abs(gx) + abs(gy);
+		o[0] = magnitude > 255 ? 255 : magnitude;
+
+		sobel_cpu_row(t, m, b, o, 1, TILE_OUT_COLS);
+	}
+
+	// The shift register ends up holding the tail of the frame, the counters wrap to zero
+	for (uint32_t k = TILE_IN_SIZE - EMU_RING_SIZE; k < TILE_IN_SIZE; k++) {
+		core->ring[(core->n + k) & EMU_RING_MASK] = src[k];
+	}
+	core->n += TILE_IN_SIZE;
+}
+
+static int emu_tx(emu_core_t *core, struct channel_buffer *buf) {
+
+	const uint8_t *src = (const uint8_t *)buf->buffer;
+	uint32_t length = buf->length;
+
+	// Backpressure: wait until the output FIFO can take everything this transfer may produce
+	pthread_mutex_lock(&core->lock);
+	while (EMU_FIFO_SIZE - core->count < length) {
+		if (emu_wait(core) == ETIMEDOUT) {
+			pthread_mutex_unlock(&core->lock);
+			return PROXY_TIMEOUT;
+		}
+	}
+	uint32_t tail = (core->head + core->count) % EMU_FIFO_SIZE;
+	pthread_mutex_unlock(&core->lock);
+
+	// The fabric takes length / pixel_rate seconds from now to consume the transfer. Computing
+	// its output below overlaps with that, as the host and the fabric run side by side.
+	double done = emu_now() + (pixel_rate > 0.0 ? length / pixel_rate : 0.0);
+
+	uint32_t produced = 0;
+	if (length == TILE_IN_SIZE && core->row == 0 && core->col == 0 && tail + TILE_OUT_SIZE <= EMU_FIFO_SIZE) {
+		emu_frame(core, src, &core->fifo[tail]);
+		produced = TILE_OUT_SIZE;
+	} else {
+		for (uint32_t i = 0; i < length; i++) {
+			if (emu_push(core, src[i], i == length - 1, &core->fifo[tail])) {
+				tail = tail + 1 == EMU_FIFO_SIZE ? 0 : tail + 1;
+				produced++;
+			}
+		}
+	}
+
+	// Hold the transfer until the emulated fabric would have consumed it
+	double wait = done - emu_now();
+	if (wait > 0.0) {
+		struct timespec ts = { (time_t)wait, (long)((wait - (time_t)wait) * 1e9) };
+		nanosleep(&ts, NULL);
+	}
+
+	pthread_mutex_lock(&core->lock);
+	core->count += produced;
+	core->regs[INPUT_COUNT_REG_OFFSET >> 2] += length;
+	core->regs[CLOCK_COUNT_REG_OFFSET >> 2] += length;
+	pthread_cond_broadcast(&core->cond);
+	pthread_mutex_unlock(&core->lock);
+
+	return PROXY_NO_ERROR;
+}
+
+static int emu_rx(emu_core_t *core, struct channel_buffer *buf) {
+
+	uint8_t *dst = (uint8_t *)buf->buffer;
+	uint32_t length = buf->length;
+
+	pthread_mutex_lock(&core->lock);
+	while (core->count < length) {
+		if (emu_wait(core) == ETIMEDOUT) {
+			pthread_mutex_unlock(&core->lock);
+			return PROXY_TIMEOUT;
+		}
+	}
+
+	uint32_t first = EMU_FIFO_SIZE - core->head < length ? EMU_FIFO_SIZE - core->head : length;
+	memcpy(dst, core->fifo + core->head, first);
+	memcpy(dst + first, core->fifo, length - first);
+
+	core->head = (core->head + length) % EMU_FIFO_SIZE;
+	core->count -= length;
+	core->regs[OUTPUT_COUNT_REG_OFFSET >> 2] += length;
+	pthread_cond_broadcast(&core->cond);
+	pthread_mutex_unlock(&core->lock);
+
+	return PROXY_NO_ERROR;
+}
+
+/*
+ * Emulated AXI_DMA_Init(). The channel name selects the core (trailing index) and the
+ * direction (tx/rx); both are encoded as a negative file descriptor so close() is harmless.
+ * @param channel : Pointer to the DMA channel structure (either RX or TX).
+ * @return        : SOBEL_SUCCESS on success, SOBEL_FAILURE on failure.
+ */
+int emulator_channel_init(Channel *channel) {
+
+	pthread_once(&cores_once, emu_init_cores);
+
+	const char *index = strrchr(channel->name, '_');
+	int instance = index ? atoi(index + 1) : 0;
+
+	if (instance < 0 || instance >= EMU_MAX_INSTANCES) {
+		return SOBEL_FAILURE;
+	}
+
+	channel->fd = -(instance * 2 + (strstr(channel->name, "rx") != NULL)) - 1;
+	channel->buf_ptr = (struct channel_buffer *)aligned_alloc(1024, sizeof(struct channel_buffer) * 2);
+
+	return channel->buf_ptr ? SOBEL_SUCCESS : SOBEL_FAILURE;
+} /* end of emulator_channel_init() */
+
+/*
+ * Emulated XFER ioctl: blocks until the transfer completes and reports the proxy status.
+ * @param channel : The DMA channel.
+ * @param buf_id  : The channel buffer to transfer.
+ * @return        : 0 (errors are reported through the buffer status, as in the driver).
+ */
+int emulator_transfer(Channel *channel, int buf_id) {
+
+	int id = -channel->fd - 1;
+	emu_core_t *core = &cores[id / 2];
+	struct channel_buffer *buf = &channel->buf_ptr[buf_id];
+
+	if (!(core->regs[ENABLE_REG_OFFSET >> 2] & 0x1)) {
+		buf->status = PROXY_TIMEOUT;  // the FIFOs are held in reset
+		return 0;
+	}
+
+	buf->status = (id & 1) ? emu_rx(core, buf) : emu_tx(core, buf);
+
+	return 0;
+} /* end of emulator_transfer() */
+
+/*
+ * Emulated /dev/mem mapping of a Sobel IP core register block.
+ * @param reg : AXI Lite register data structure (base must be set).
+ * @return    : SOBEL_SUCCESS on success, SOBEL_FAILURE on failure.
+ */
+int emulator_register_map(AXILite_Register_t *reg) {
+
+	pthread_once(&cores_once, emu_init_cores);
+
+	uint32_t instance = (reg->base - SOBEL_IP_CORE_REG_BASE) / SOBEL_IP_CORE_REG_STRIDE;
+
+	if (reg->base < SOBEL_IP_CORE_REG_BASE || instance >= EMU_MAX_INSTANCES) {
+		return SOBEL_FAILURE;
+	}
+
+	reg->ptr = cores[instance].regs;
+
+	return SOBEL_SUCCESS;
+} /* end of emulator_register_map() */
+
+/*
+ * Emulated register write. Clearing the enable bit resets the core, its FIFOs and counters
+ * (sobel_rst_n <= rst_n and en).
+ * @param reg    : AXI Lite register data structure.
+ * @param offset : Offset from the base address of the AXI Lite register.
+ * @param data   : The unsigned 32-bit data to write.
+ */
+void emulator_register_write(AXILite_Register_t *reg, uint32_t offset, uint32_t data) {
+
+	emu_core_t *core = (emu_core_t *)((char *)reg->ptr - offsetof(emu_core_t, regs));
+
+	pthread_mutex_lock(&core->lock);
+
+	reg->ptr[offset >> 2] = data;
+
+	if (offset == ENABLE_REG_OFFSET && !(data & 0x1)) {
+		emu_reset(core);
+	}
+
+	pthread_cond_broadcast(&core->cond);
+	pthread_mutex_unlock(&core->lock);
+} /* end of emulator_register_write() */
@@ -0,0 +1,185 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "hybrid.h"
+#include "tiler.h"
+#include "sobel_cpu.h"
+
+static double hybrid_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/*
+ * Function to reset the throughput estimates of the hybrid balancer.
+ * @param balancer : The hybrid balancer.
+ */
+void hybrid_init(hybrid_balancer_t *balancer) {
+
+    balancer->tile_time = 0.0;
+    balancer->pixel_time = 0.0;
+    balancer->tile_age = 0;
+    balancer->pixel_age = 0;
+
+} /* end of hybrid_init() */
+
+/*
+ * Function to choose the row at which a frame is split between the accelerator (rows above)
+ * and the CPU workers (rows below). The accelerator always streams whole tiles, so the split
+ * is taken at tile row boundaries and the one minimising the estimated time of the slower
+ * engine is picked. Until both engines have been measured, the split probes the missing one.
+ * An engine the split leaves idle for HYBRID_PROBE_FRAMES frames gets one tile row again, so
+ * its estimate follows changes in load instead of freezing at the value that excluded it.
+ * @param balancer : The hybrid balancer.
+ * @param Nx       : Image columns.
+ * @param Ny       : Image rows.
+ * @return         : The first row processed by the CPU workers.
+ */
+int hybrid_split(const hybrid_balancer_t *balancer, int Nx, int Ny) {
+
+    sobel_tiler_t frame;
+    tiler_init(&frame, Nx, Ny, 0, Ny);
+
+    int K = frame.tiles_y;
+    int k = K;
+
+    if (balancer->tile_time <= 0.0 && balancer->pixel_time <= 0.0) {
+
+        k = (K + 1) / 2;  // measure both engines on the first frame when it has room for both
+
+    } else if (balancer->tile_time <= 0.0) {
+
+        k = K;
+
+    } else if (balancer->pixel_time <= 0.0) {
+
+        k = 0;
+
+    } else {
+
+        double best = -1.0;
+
+        for (int i = K; i >= 0; i--) {
+
+            int split = i == K ? Ny : (i == 0 ? 0 : 1 + i * TILE_STEP_Y);
+
+            double t_fpga = (double)i * frame.tiles_x * balancer->tile_time;
+            double t_cpu  = (double)(Ny - split) * Nx * balancer->pixel_time;
+            double t      = t_fpga > t_cpu ? t_fpga : t_cpu;
+
+            if (best < 0.0 || t < best) {
+                best = t;
+                k = i;
+            }
+        }
+
+        if (k == 0 && K > 0 && balancer->tile_age >= HYBRID_PROBE_FRAMES) {
+            k = 1;
+        } else if (k == K && K > 0 && balancer->pixel_age >= HYBRID_PROBE_FRAMES) {
+            k = K - 1;
+        }
+    }
+
+    return k == K ? Ny : (k == 0 ? 0 : 1 + k * TILE_STEP_Y);
+
+} /* end of hybrid_split() */
+
+/*
+ * Function to fold the measured throughput of the last frame into the estimates. A probe of
+ * an engine that sat idle replaces its stale estimate instead of being averaged with it.
+ * @param balancer  : The hybrid balancer.
+ * @param tiles     : Number of tiles processed by the accelerator.
+ * @param fpga_time : Time the DMA threads took to stream the tiles, in seconds.
+ * @param pixels    : Number of pixels processed by the CPU workers.
+ * @param cpu_time  : Time the CPU workers took, in seconds.
+ */
+void hybrid_update(hybrid_balancer_t *balancer, int tiles, double fpga_time, long pixels, double cpu_time) {
+
+    if (tiles > 0 && fpga_time > 0.0) {
+        double sample = fpga_time / tiles;
+        balancer->tile_time = balancer->tile_time > 0.0 && balancer->tile_age < HYBRID_PROBE_FRAMES ? HYBRID_SMOOTHING * sample + (1.0 - HYBRID_SMOOTHING) * balancer->tile_time : sample;
+        balancer->tile_age = 0;
+    } else {
+        balancer->tile_age++;
+    }
+
+    if (pixels > 0 && cpu_time > 0.0) {
+        double sample = cpu_time / pixels;
+        balancer->pixel_time = balancer->pixel_time > 0.0 && balancer->pixel_age < HYBRID_PROBE_FRAMES ? HYBRID_SMOOTHING * sample + (1.0 - HYBRID_SMOOTHING) * balancer->pixel_time : sample;
+        balancer->pixel_age = 0;
+    } else {
+        balancer->pixel_age++;
+    }
+
+} /* end of hybrid_update() */
+
+/*
+ * Function to start the software Sobel workers on the rows [y0, y1), split evenly between them.
+ * @param args : The worker arguments (n entries).
+ * @param n    : Number of workers.
+ * @param in   : Input image.
+ * @param out  : Output image.
+ * @param Nx   : Image columns.
+ * @param Ny   : Image rows.
+ * @param y0   : First row of the CPU band.
+ * @param y1   : One past the last row of the CPU band.
+ */
+void create_cpu_threads(cpu_thread_args_t *args, int n, const uint8_t *in, uint8_t *out, int Nx, int Ny, int y0, int y1) {
+
+    for (int i = 0; i < n; i++) {
+
+        args[i].in = in;
+        args[i].out = out;
+        args[i].Nx = Nx;
+        args[i].Ny = Ny;
+        args[i].y0 = y0 + (int)((long)(y1 - y0) * i / n);
+        args[i].y1 = y0 + (int)((long)(y1 - y0) * (i + 1) / n);
+        args[i].elapsed = 0.0;
+
+        pthread_create(&args[i].tid, NULL, cpu_worker, (void *)&args[i]);
+    }
+
+} /* end of create_cpu_threads() */
+
+/*
+ * Function to wait for the software Sobel workers.
+ * @param args : The worker arguments (n entries).
+ * @param n    : Number of workers.
+ * @return     : The time taken by the slowest worker, in seconds.
+ */
+double join_cpu_threads(cpu_thread_args_t *args, int n) {
+
+    double elapsed = 0.0;
+
+    for (int i = 0; i < n; i++) {
+        pthread_join(args[i].tid, NULL);
+        if (args[i].elapsed > elapsed) {
+            elapsed = args[i].elapsed;
+        }
+    }
+
+    return elapsed;
+
+} /* end of join_cpu_threads() */
+
+/*
+ * CPU worker thread. Computes the Sobel magnitude of its band. Neighbour rows outside
+ * the band are read from the full image, so the seams with the accelerator band are exact.
+ * @param args : The worker arguments.
+ */
+void *cpu_worker(void *args) {
+
+    cpu_thread_args_t *worker = (cpu_thread_args_t *)args;
+
+    double start = hybrid_now();
+
+    sobel_cpu_manhattan(worker->in, worker->out, worker->Nx, worker->Ny, 0, worker->y0, worker->Nx, worker->y1);
+
+    worker->elapsed = hybrid_now() - start;
+
+    return NULL;
+
+} /* end of cpu_worker() */
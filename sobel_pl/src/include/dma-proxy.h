@@ -1,6 +1,6 @@
 #include <linux/ioctl.h>
 
-#define BUFFER_SIZE (128 * 1024)
+#define BUFFER_SIZE (256 * 1024)
 #define BUFFER_COUNT 1
 #define TX_BUFFER_COUNT 1
 #define RX_BUFFER_COUNT 1
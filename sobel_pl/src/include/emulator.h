@@ -0,0 +1,20 @@
+#ifndef _EMULATOR_H_
+#define _EMULATOR_H_
+
+#include <stdint.h>
+
+#include "pl.h"
+
+#define EMU_MAX_INSTANCES		8				// number of emulated Sobel IP cores
+#define EMU_PIXEL_RATE			100000000.0		// default emulated fabric rate in pixels/s (SOBEL_EMU_RATE overrides, 0 = unpaced)
+#define EMU_TIMEOUT_MS			3000			// same as the dma-proxy driver
+
+int emulator_channel_init( Channel *channel );
+
+int emulator_transfer( Channel *channel, int buf_id );
+
+int emulator_register_map( AXILite_Register_t *reg );
+
+void emulator_register_write( AXILite_Register_t *reg, uint32_t offset, uint32_t data );
+
+#endif // _EMULATOR_H_
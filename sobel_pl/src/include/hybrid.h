@@ -0,0 +1,45 @@
+#ifndef _HYBRID_H_
+#define _HYBRID_H_
+
+#include <pthread.h>
+#include <stdint.h>
+
+#define CPU_WORKER_THREADS		2		// software Sobel workers (one per Cortex-A9 core)
+#define HYBRID_SMOOTHING		0.5		// weight of the newest throughput sample
+#define HYBRID_PROBE_FRAMES		16		// frames an engine may sit idle before it gets one tile row again
+
+typedef struct {
+
+	const uint8_t *in;		// Input image
+	uint8_t *out;			// Output image
+	int Nx;					// Image columns
+	int Ny;					// Image rows
+	int y0;					// First row of the band
+	int y1;					// One past the last row of the band
+	double elapsed;			// Time spent on the band in seconds
+	pthread_t tid;
+
+} cpu_thread_args_t;
+
+typedef struct {
+
+	double tile_time;		// Seconds per tile on the accelerator (0 = not measured yet)
+	double pixel_time;		// Seconds per pixel on the CPU workers (0 = not measured yet)
+	int tile_age;			// Frames since the accelerator was last measured
+	int pixel_age;			// Frames since the CPU workers were last measured
+
+} hybrid_balancer_t;
+
+void hybrid_init( hybrid_balancer_t *balancer );
+
+int hybrid_split( const hybrid_balancer_t *balancer, int Nx, int Ny );
+
+void hybrid_update( hybrid_balancer_t *balancer, int tiles, double fpga_time, long pixels, double cpu_time );
+
+void create_cpu_threads( cpu_thread_args_t *args, int n, const uint8_t *in, uint8_t *out, int Nx, int Ny, int y0, int y1 );
+
+double join_cpu_threads( cpu_thread_args_t *args, int n );
+
+void *cpu_worker( void *args );
+
+#endif // _HYBRID_H_
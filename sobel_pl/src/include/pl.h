@@ -9,8 +9,8 @@
 #define SOBEL_SUCCESS  0
 #define SOBEL_FAILURE -1
 
-#define DMA_TX_CHANNEL_NAME "dma_proxy_tx_0"
-#define DMA_RX_CHANNEL_NAME "dma_proxy_rx_0"
+#define DMA_TX_CHANNEL_NAME "dma_proxy_tx_%d"	// instance index appended, as in the device tree dma-names
+#define DMA_RX_CHANNEL_NAME "dma_proxy_rx_%d"
 
 typedef struct{
 
@@ -36,5 +36,9 @@ uint32_t AXILite_Register_Read( AXILite_Register_t * AxiRegs, uint32_t offset );
 
 int AXI_DMA_Init( Channel *channel );
 
+int AXI_DMA_Transfer( Channel *channel, int buf_id );
+
+int AXILite_Register_Map( AXILite_Register_t * AxiRegs );
+
 
 #endif // _PL_H_
@@ -0,0 +1,53 @@
+#ifndef _REPORT_H_
+#define _REPORT_H_
+
+#include <stdint.h>
+
+#include "sobel_pl.h"
+
+#define REPORT_NONE				0
+#define REPORT_JSON				1		// one JSON object per run (JSON Lines when appended to a file)
+#define REPORT_CSV				2		// one CSV row per run, header written when the file is new
+
+typedef struct {
+
+	uint32_t in;			// INPUT_COUNT_REG  : pixels accepted on s_axis
+	uint32_t out;			// OUTPUT_COUNT_REG : pixels produced on m_axis
+	uint32_t cycles;		// CLOCK_COUNT_REG  : active clk_int cycles
+
+} report_counters_t;
+
+typedef struct {
+
+	int frames;				// Frames aggregated
+	int failed;				// A frame failed and the run stopped (integrity is reported false)
+	long tiles;				// Tiles streamed to the IP cores
+	uint64_t pixels;		// Image pixels produced (all engines)
+	uint64_t fpga_pixels;	// Pixels streamed to the IP cores
+
+	uint64_t in_count;		// Sum of the INPUT_COUNT_REG deltas
+	uint64_t out_count;		// Sum of the OUTPUT_COUNT_REG deltas
+	uint64_t cycles;		// Sum of the CLOCK_COUNT_REG deltas over all instances
+	double fabric_time;		// Sum over frames of the busiest instance's cycles / SOBEL_IP_CORE_CLK_HZ
+
+	double proc_time;		// Sum of the end-to-end frame times
+	double fpga_time;		// Sum of the times the DMA threads took to stream the tiles
+	double border_time;		// Sum of the times the PS took to fill in the tile borders
+	double cpu_time;		// Sum of the CPU worker times
+	double frame_min;		// Fastest frame
+	double frame_max;		// Slowest frame
+
+} sobel_report_t;
+
+int report_format( const char *name );
+
+void report_init( sobel_report_t *report );
+
+void report_read_counters( const sobel_edge_detection_t *params, report_counters_t *counters );
+
+void report_frame( sobel_report_t *report, const sobel_edge_detection_t *params, const report_counters_t *before,
+                   const report_counters_t *after, double frame_time, double fpga_time, double border_time, double cpu_time );
+
+int report_write( const sobel_report_t *report, const sobel_edge_detection_t *params );
+
+#endif // _REPORT_H_
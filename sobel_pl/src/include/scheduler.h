@@ -0,0 +1,41 @@
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+#include <pthread.h>
+
+#define TILE_FIFO_DEPTH			16		 // tiles an instance may have in flight between its TX and RX threads
+
+typedef struct {
+
+	int tiles[TILE_FIFO_DEPTH];	// Tile indices in the order they were streamed (-1 = end of frame)
+	int head;
+	int count;
+
+} tile_fifo_t;
+
+typedef struct {
+
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+
+	int next;					// Next tile to dispatch
+	int count;					// Number of tiles in the frame
+	int halt;					// Set by a failing thread to stop all instances
+
+} tile_queue_t;
+
+void tile_queue_init( tile_queue_t *queue, int count );
+
+void tile_queue_destroy( tile_queue_t *queue );
+
+int tile_queue_next( tile_queue_t *queue );
+
+void tile_queue_halt( tile_queue_t *queue );
+
+void tile_fifo_init( tile_fifo_t *fifo );
+
+int tile_fifo_push( tile_queue_t *queue, tile_fifo_t *fifo, int tile );
+
+int tile_fifo_pop( tile_queue_t *queue, tile_fifo_t *fifo );
+
+#endif // _SCHEDULER_H_
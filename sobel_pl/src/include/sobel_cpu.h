@@ -0,0 +1,10 @@
+#ifndef _SOBEL_CPU_H_
+#define _SOBEL_CPU_H_
+
+#include <stdint.h>
+
+void sobel_cpu_row( const uint8_t *t, const uint8_t *m, const uint8_t *b, uint8_t *o, int x0, int x1 );
+
+void sobel_cpu_manhattan( const uint8_t *in, uint8_t *out, int Nx, int Ny, int x0, int y0, int x1, int y1 );
+
+#endif // _SOBEL_CPU_H_
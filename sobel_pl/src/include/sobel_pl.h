@@ -2,9 +2,17 @@
 #define _SOBEL_PL_H_
 
 #include "pl.h"
+#include "tiler.h"
+#include "hybrid.h"
+#include "scheduler.h"
+#include "trace.h"
 
 #define SOBEL_IP_CORE_REG_BASE 		0x43c00000	 // the sobel edge detector AXI-Lite MMAP Registers base address
 #define SOBEL_IP_CORE_REG_SIZE 		4 * 1024	 // the range to allocate for the IP core's control registers
+#define SOBEL_IP_CORE_REG_STRIDE	0x10000		 // address distance between the register blocks of consecutive IP core instances
+#define SOBEL_IP_CORE_CLK_HZ		200000000	 // op_aclk, the clk_int domain CLOCK_COUNT_REG counts in
+
+#define SOBEL_MAX_INSTANCES		8		 // Sobel IP core instances, each behind its own dma_proxy_tx_N / dma_proxy_rx_N pair
 
 #define ENABLE_REG_OFFSET		0x00		 // system enable     : Enable_Reg    <= 	0x00[0:0]
 #define CLOCK_COUNT_REG_OFFSET		0x04		 // input data count  : Clock_Count_Reg  <= 	0x04[31:0]
@@ -13,20 +21,49 @@
 
 #define CHUNK_SIZE_PER_TRANSFER		4096		 // increase this for faster processing. Caution however is needed! The transfer size that
 							 // the AXI DMA IP core can handle must be an integer power of 2.
+							 // S2MM only: every tile goes out as one MM2S transfer of TILE_IN_SIZE
+							 // bytes, which needs a buffer length register of at least 19 bits.
+
+#if BUFFER_SIZE < TILE_IN_SIZE
+#error "dma-proxy BUFFER_SIZE must hold a whole tile, the core resets on the tlast of every MM2S transfer"
+#endif
 
 //#define IS_VERBOSE // uncomment this for verbose messages
 
+#define MODE_FPGA			0		 // every tile goes through the IP core (default)
+#define MODE_CPU			1		 // software Sobel on the PS cores only
+#define MODE_HYBRID			2		 // frames are split between the IP core and the PS cores
+
 typedef struct {
 
 	Channel *channel;		// DMA channel
-	char *file;				// input filename
+	sobel_tiler_t *tiler;	// Tile layout of the image
+	uint8_t *image;			// Image to gather tiles from (TX) or scatter tiles into (RX)
+	tile_queue_t *queue;	// Tiles of the frame shared by all instances
+	tile_fifo_t *inflight;	// Tiles streamed to this instance, in order (TX pushes, RX pops)
+	trace_buffer_t *trace;	// Timing of every chunk, written by this thread only
 	uint32_t transfer_size;	// Transfer size in bytes	
-	uint32_t total_size;	// Total data size in bytes
 	uint32_t status;		// The worker status
 	int halt_op;			// Halt signal (not used here)
 
 }dma_thread_args_t;
 
+typedef struct {
+
+	Channel *rx_channel;	// DMA receiver channel
+	Channel *tx_channel;	// DMA transmitter channel
+
+	AXILite_Register_t *reg; // Sobel IP core registers
+
+	dma_thread_args_t tx_args;	// TX thread arguments
+	dma_thread_args_t rx_args;	// RX thread arguments
+	tile_fifo_t inflight;		// Tiles between the TX and the RX thread
+
+	trace_buffer_t tx_trace;	// Chunk timing of the TX thread
+	trace_buffer_t rx_trace;	// Chunk timing of the RX thread
+
+} sobel_instance_t;
+
 typedef struct {
 
     char * Fin;         // Input image file path
@@ -37,10 +74,23 @@ typedef struct {
     int fdi;            // Input image file descriptor
     int fdo;            // Output image file descriptor
 
-	Channel *rx_channel;	// DMA receiver channel
-	Channel *tx_channel;	// DMA transmitter channel
+    int mode;           // MODE_FPGA, MODE_CPU or MODE_HYBRID
+    int frames;         // Number of times the frame is processed
 
-	AXILite_Register_t *reg; // Sobel IP core registers
+    uint8_t * in_image;     // Input image (mapped input file, or a DRAM copy)
+    uint8_t * out_image;    // Output image (mapped output file, or a DRAM copy)
+    int in_mapped;          // in_image is a file mapping
+    int out_mapped;         // out_image is a file mapping
+    sobel_tiler_t tiler;    // Tile layout for the fixed-size IP core
+
+    int instances;          // Number of Sobel IP core instances in use
+    sobel_instance_t *inst; // The Sobel IP core instances
+
+    char * trace_file;      // Chrome trace-event JSON output path (NULL = no timeline)
+    trace_buffer_t trace;   // File I/O timing of the main thread
+
+    int report_format;      // REPORT_NONE, REPORT_JSON or REPORT_CSV
+    char * report_file;     // File the report is appended to (NULL = stdout)
 
 } sobel_edge_detection_t;
 
@@ -48,7 +98,13 @@ int get_input(int argc, char * argv[], sobel_edge_detection_t * params);
 
 int setup(sobel_edge_detection_t * params);
 
-void create_thread(dma_thread_args_t *thread_args, Channel *channel, void *handler, char *file, int transfer_size, int total_size);
+int load_image(sobel_edge_detection_t * params);
+
+int store_image(sobel_edge_detection_t * params);
+
+void release_image(sobel_edge_detection_t * params);
+
+void create_thread(dma_thread_args_t *thread_args, Channel *channel, void *handler, sobel_tiler_t *tiler, uint8_t *image, tile_queue_t *queue, tile_fifo_t *inflight, trace_buffer_t *trace, int transfer_size);
 
 struct timeval get_time(void);
 
@@ -0,0 +1,49 @@
+#ifndef _TILER_H_
+#define _TILER_H_
+
+#include <stdint.h>
+
+#define SOBEL_IP_CORE_ROWS		512		 // frame rows the IP core is synthesised for    (image_rows in my_types.vhd)
+#define SOBEL_IP_CORE_COLS		512		 // frame columns the IP core is synthesised for (image_columns in my_types.vhd)
+
+#define TILE_IN_SIZE			( SOBEL_IP_CORE_ROWS * SOBEL_IP_CORE_COLS )	// bytes streamed to the core per tile
+#define TILE_OUT_ROWS			( SOBEL_IP_CORE_ROWS - 2 )			// the window buffer crops the first two rows ...
+#define TILE_OUT_COLS			( SOBEL_IP_CORE_COLS - 2 )			// ... and the first two columns of every row
+#define TILE_OUT_SIZE			( TILE_OUT_ROWS * TILE_OUT_COLS )	// bytes returned by the core per tile
+
+// The window buffer emits the window of the pixel *preceding* the one it accepts, so output (i, j)
+// of a tile is the gradient centred at tile pixel (i + 1, j). Output column 0 borrows its left
+// neighbours from the previous row and is discarded, which leaves tile columns 1 .. COLS - 3 valid.
+#define TILE_STEP_Y				( SOBEL_IP_CORE_ROWS - 2 )	// valid rows per tile
+#define TILE_STEP_X				( SOBEL_IP_CORE_COLS - 3 )	// valid columns per tile
+
+typedef struct {
+
+	int Nx;				// Image columns
+	int Ny;				// Image rows
+
+	int y0;				// First row of the band handled by the tiler
+	int y1;				// One past the last row of the band
+
+	int tiles_x;		// Number of tile columns
+	int tiles_y;		// Number of tile rows
+
+	int first_y;		// First image row produced by the accelerator
+	int last_y;			// Last image row produced by the accelerator
+	int last_x;			// Last image column produced by the accelerator
+
+} sobel_tiler_t;
+
+void tiler_init( sobel_tiler_t *tiler, int Nx, int Ny, int y0, int y1 );
+
+uint32_t tiler_input_size( const sobel_tiler_t *tiler );
+
+uint32_t tiler_output_size( const sobel_tiler_t *tiler );
+
+void tiler_gather( const sobel_tiler_t *tiler, const uint8_t *image, uint32_t offset, uint8_t *dst, uint32_t length );
+
+void tiler_scatter( const sobel_tiler_t *tiler, uint8_t *image, uint32_t offset, const uint8_t *src, uint32_t length );
+
+void tiler_fix_borders( const sobel_tiler_t *tiler, const uint8_t *in, uint8_t *out );
+
+#endif // _TILER_H_
@@ -0,0 +1,50 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <stdint.h>
+
+#define TRACE_MAX_EVENTS		( 1 << 20 )	// events kept per buffer; later events are only counted
+
+#define TRACE_GATHER			0		// TX : copy of a chunk from the input image into the DMA buffer
+#define TRACE_XFER				1		// TX / RX : blocking XFER ioctl of a chunk
+#define TRACE_SCATTER			2		// RX : copy of a chunk from the DMA buffer into the output image
+#define TRACE_ERROR				3		// TX / RX : failed or timed out XFER
+#define TRACE_LOAD				4		// main : input file read
+#define TRACE_STORE				5		// main : output file write
+#define TRACE_KINDS				6
+
+typedef struct {
+
+	uint64_t start;			// Monotonic start time in ns
+	uint32_t duration;		// Duration in ns
+	int32_t tile;			// Tile the chunk belongs to (-1 if none)
+	uint16_t kind;			// TRACE_GATHER ... TRACE_STORE
+
+} trace_event_t;
+
+// Every buffer is written by a single thread only and read after that thread has been
+// joined, so recording needs no locks or atomics. Events are allocated up front for the
+// whole run, so recording never allocates either; events past the capacity are counted.
+typedef struct {
+
+	char name[32];			// Thread name shown in the reports
+	trace_event_t *events;
+	uint32_t count;			// Recorded events
+	uint32_t capacity;		// Allocated events
+	uint32_t dropped;		// Events beyond the capacity (or lost to a failed allocation)
+
+} trace_buffer_t;
+
+uint64_t trace_now( void );
+
+void trace_init( trace_buffer_t *buffer, const char *name, uint64_t events );
+
+void trace_free( trace_buffer_t *buffer );
+
+void trace_record( trace_buffer_t *buffer, int kind, uint64_t start, uint64_t end, int tile );
+
+void trace_report( trace_buffer_t **buffers, int n );
+
+int trace_write_chrome( const char *path, trace_buffer_t **buffers, int n );
+
+#endif // _TRACE_H_
@@ -9,6 +9,7 @@
 
 #include "sobel_pl.h"
 #include "pl.h"
+#include "report.h"
 
 int main (int argc, char *argv[]) {
 	
@@ -22,72 +23,199 @@ int main (int argc, char *argv[]) {
 	printf("\n\n");
 
 	sobel_edge_detection_t params;
-	dma_thread_args_t *tx_args;
-	dma_thread_args_t *rx_args;
+	tile_queue_t queue;
 
     if ( get_input(argc, argv, &params) != SOBEL_SUCCESS ) {  exit( SOBEL_FAILURE ); }
 
 	if ( setup( &params ) != SOBEL_SUCCESS ) 			   {  exit( SOBEL_FAILURE ); } 
+
+	if ( load_image( &params ) != SOBEL_SUCCESS ) 		   {  exit( SOBEL_FAILURE ); }
 	
-	int N = params.Nx * params.Ny;
-	
-	tx_args =  (dma_thread_args_t *)malloc( sizeof(dma_thread_args_t) );
-	rx_args =  (dma_thread_args_t *)malloc( sizeof(dma_thread_args_t) );
-	
-	if (!(tx_args) || !(rx_args)) {
-
-		printf("[ERROR] Failed to allocate memory for DMA thread arguments \n");
-		printf("[STATUS] Exiting with failure! \n");
-		
-		free(tx_args);
-		free(rx_args);
-		
-		exit(SOBEL_FAILURE);
-	}
+	cpu_thread_args_t cpu_args[CPU_WORKER_THREADS];
+	hybrid_balancer_t balancer;
+
+	hybrid_init( &balancer );
 
 	printf("[STATUS] Starting the edge detection processing \n");
 
-    struct timeval t_start = get_time();
-	
-	// Configure and create the threads
-	create_thread( rx_args, params.rx_channel, pl2ps, params.Fout, CHUNK_SIZE_PER_TRANSFER, N);
-    create_thread( tx_args, params.tx_channel, ps2pl, params.Fin, CHUNK_SIZE_PER_TRANSFER, N);
-	 
-	// Join threads on termination or error
-	pthread_join(params.rx_channel->tid, NULL);
-	pthread_join(params.tx_channel->tid, NULL);
-	
-	// error from the threads
-	if (( rx_args->status == SOBEL_FAILURE || tx_args->status == SOBEL_FAILURE )) {  
+	int failed = 0;
+	int split = params.Ny;
+	double proc_time = 0.0;
+
+	sobel_report_t report;
+	report_counters_t counters_before[SOBEL_MAX_INSTANCES];
+	report_counters_t counters_after[SOBEL_MAX_INSTANCES];
+
+	report_init( &report );
+
+	for (int frame = 0; frame < params.frames; frame++) {
+
+		// Rows [0, split) go through the IP core, rows [split, Ny) through the CPU workers
+		if      ( params.mode == MODE_FPGA ) { split = params.Ny; }
+		else if ( params.mode == MODE_CPU )  { split = 0; }
+		else                                 { split = hybrid_split( &balancer, params.Nx, params.Ny ); }
+
+		tiler_init( &params.tiler, params.Nx, params.Ny, 0, split );
+
+		report_read_counters( &params, counters_before );
+
+		struct timeval t_start = get_time();
+
+		create_cpu_threads( cpu_args, CPU_WORKER_THREADS, params.in_image, params.out_image, params.Nx, params.Ny, split, params.Ny );
+
+		int tiles = params.tiler.tiles_x * params.tiler.tiles_y;
+		int status = SOBEL_SUCCESS;
+
+		if ( tiles > 0 ) {
+
+			// Every instance pulls tiles from the shared queue until the frame is exhausted
+			tile_queue_init( &queue, tiles );
+
+			// Configure and create the threads
+			for (int i = 0; i < params.instances; i++) {
+
+				sobel_instance_t *inst = &params.inst[i];
+
+				tile_fifo_init( &inst->inflight );
+
+				create_thread( &inst->rx_args, inst->rx_channel, pl2ps, &params.tiler, params.out_image, &queue, &inst->inflight, &inst->rx_trace, CHUNK_SIZE_PER_TRANSFER );
+				create_thread( &inst->tx_args, inst->tx_channel, ps2pl, &params.tiler, params.in_image,  &queue, &inst->inflight, &inst->tx_trace, TILE_IN_SIZE );
+			}
+		 
+			// Join threads on termination or error
+			for (int i = 0; i < params.instances; i++) {
+
+				pthread_join(params.inst[i].rx_channel->tid, NULL);
+				pthread_join(params.inst[i].tx_channel->tid, NULL);
+
+				if ( params.inst[i].rx_args.status == SOBEL_FAILURE || params.inst[i].tx_args.status == SOBEL_FAILURE ) {
+					status = SOBEL_FAILURE;
+				}
+			}
+
+			tile_queue_destroy( &queue );
+		}
+
+		double fpga_time = elapsed_time(t_start, get_time());
+
+		// Pixels of the accelerator band the IP core does not produce, computed on the PS
+		struct timeval t_border = get_time();
+
+		tiler_fix_borders( &params.tiler, params.in_image, params.out_image );
+
+		double border_time = elapsed_time(t_border, get_time());
+		double cpu_time    = join_cpu_threads( cpu_args, CPU_WORKER_THREADS );
+		double frame_time  = elapsed_time(t_start, get_time());
 
-		printf("[ERROR] Threads terminated with errors. \n");
+		// error from the threads
+		if ( status == SOBEL_FAILURE ) {  
+
+			printf("[ERROR] Threads terminated with errors. \n");
+			failed = 1;
+			report.failed = 1;
+			break;
+		}
+
+		hybrid_update( &balancer, tiles, fpga_time, (long)(params.Ny - split) * params.Nx, cpu_time );
+
+		proc_time += frame_time;
+
+		report_read_counters( &params, counters_after );
+		report_frame( &report, &params, counters_before, counters_after, frame_time, fpga_time, border_time, cpu_time );
+
+		if ( params.mode == MODE_HYBRID ) {
+			printf("[INFO] Frame %d : %d rows on the IP core (%.2f ms + %.2f ms borders), %d rows on the CPU (%.2f ms) \n",
+			       frame, split, fpga_time * 1000.0, border_time * 1000.0, params.Ny - split, cpu_time * 1000.0);
+		}
+	}
+
+	if ( failed ) {
+
+		// already reported
+
+	} else if ( store_image( &params ) != SOBEL_SUCCESS ) {
+
+		printf("[ERROR] Failed to store the output image. \n");
 
 	} else { 
-		
-		struct timeval t_end = get_time();
-		double proc_time = elapsed_time(t_start, t_end);
+
+		uint32_t bytes_in = 0, bytes_out = 0, cycles = 0;
+
+		for (int i = 0; i < params.instances; i++) {
+			bytes_in  += AXILite_Register_Read(params.inst[i].reg, INPUT_COUNT_REG_OFFSET);
+			bytes_out += AXILite_Register_Read(params.inst[i].reg, OUTPUT_COUNT_REG_OFFSET);
+			cycles     = MAX(cycles, AXILite_Register_Read(params.inst[i].reg, CLOCK_COUNT_REG_OFFSET));
+		}
 
 		printf("[INFO] The processed image is stored at : %s \n", params.Fout);
 
 		printf("\n\n");
 		printf("---------------------------------------- \n");
-		printf("Processing Time (Measured in Software) : %.2f ms \n", proc_time * 1000.0 );
-		printf("Total throughput (Measured in Software): %.2f bps \n", (double) params.Nx * params.Ny * 8 / proc_time);
-		printf("Number of bytes read (Core stats)      : %d   bytes \n", AXILite_Register_Read(params.reg, INPUT_COUNT_REG_OFFSET));
-		printf("Number of bytes written (Core stats)   : %d   bytes \n", AXILite_Register_Read(params.reg, OUTPUT_COUNT_REG_OFFSET));
-		printf("Number of clock cycles (Core stats)    : %d   cc \n", AXILite_Register_Read(params.reg, CLOCK_COUNT_REG_OFFSET));
+		printf("Processing Time (Measured in Software) : %.2f ms \n", proc_time * 1000.0 / params.frames );
+		printf("Total throughput (Measured in Software): %.2f bps \n", (double) params.Nx * params.Ny * 8 * params.frames / proc_time);
+		printf("Number of frames                       : %d \n", params.frames);
+		printf("Number of tiles                        : %d x %d \n", params.tiler.tiles_x, params.tiler.tiles_y);
+		printf("Rows processed by the CPU (last frame) : %d \n", params.Ny - split);
+		printf("Number of IP core instances            : %d \n", params.instances);
+		printf("Number of bytes read (Core stats)      : %u   bytes \n", bytes_in);
+		printf("Number of bytes written (Core stats)   : %u   bytes \n", bytes_out);
+		printf("Number of clock cycles (Core stats)    : %u   cc \n", cycles);
+
+		if ( params.instances > 1 ) {
+			for (int i = 0; i < params.instances; i++) {
+				printf("  Core %d : %u bytes read, %u bytes written, %u cc \n", i,
+				       AXILite_Register_Read(params.inst[i].reg, INPUT_COUNT_REG_OFFSET),
+				       AXILite_Register_Read(params.inst[i].reg, OUTPUT_COUNT_REG_OFFSET),
+				       AXILite_Register_Read(params.inst[i].reg, CLOCK_COUNT_REG_OFFSET));
+			}
+		}
+
 		printf("---------------------------------------- \n");
 		printf("\n\n");
 
 	}
 
-	AXILite_Register_Write(params.reg, 0x00, 0x00);
+	if ( params.report_format != REPORT_NONE && report_write( &report, &params ) != SOBEL_SUCCESS ) {
+		printf("[ERROR] Failed to write the report to : %s \n", params.report_file);
+	}
+
+	// Per-chunk latency of every thread, and optionally its timeline
+	trace_buffer_t *traces[1 + 2 * SOBEL_MAX_INSTANCES];
+	int n_traces = 0;
+
+	traces[n_traces++] = &params.trace;
+
+	for (int i = 0; i < params.instances; i++) {
+		traces[n_traces++] = &params.inst[i].tx_trace;
+		traces[n_traces++] = &params.inst[i].rx_trace;
+	}
+
+	trace_report( traces, n_traces );
+
+	if ( params.trace_file ) {
+
+		if ( trace_write_chrome( params.trace_file, traces, n_traces ) ) {
+			printf("[ERROR] Failed to write the trace to : %s \n", params.trace_file);
+		} else {
+			printf("[INFO] The DMA timeline is stored at : %s \n", params.trace_file);
+		}
+	}
+
+	for (int i = 0; i < n_traces; i++) {
+		trace_free( traces[i] );
+	}
+
+	for (int i = 0; i < params.instances; i++) {
+
+		AXILite_Register_Write(params.inst[i].reg, 0x00, 0x00);
+
+		close(params.inst[i].tx_channel->fd); 
+		close(params.inst[i].rx_channel->fd);
+	}
 
-	close(params.tx_channel->fd); 
-	close(params.rx_channel->fd);
+	free(params.inst);
 
-	free(rx_args); 
-	free(tx_args);
+	release_image( &params );
 
     return SOBEL_SUCCESS;
 
@@ -6,15 +6,25 @@
 
 #include <sys/param.h>
 #include <sys/mman.h>
+#include <sys/ioctl.h>
 
 #include "pl.h"
 
+#ifdef SOBEL_PL_EMULATE
+    #include "emulator.h"
+#endif
+
 /*
  * This function configures and sets up the AXI DMA Channel.
  * @param channel : Pointer to the DMA channel structure (either RX or TX).
  * @return        : SOBEL_SUCCESS on success, SOBEL_FAILURE on failure.
  */
 int AXI_DMA_Init (Channel *channel){
+
+	#ifdef SOBEL_PL_EMULATE
+		return emulator_channel_init(channel);
+	#endif
+
 	char chan_name[64] = "/dev/";
 	strcat(chan_name, channel->name);
 	
@@ -33,6 +43,50 @@ int AXI_DMA_Init (Channel *channel){
 	return SOBEL_SUCCESS;
 }/* end of AXI_DMA_Init() */
 
+/*
+ * This function starts a DMA transfer on a channel buffer and blocks until it completes.
+ * The outcome of the transfer is reported in the status field of the channel buffer.
+ * @param channel : Pointer to the DMA channel structure (either RX or TX).
+ * @param buf_id  : The channel buffer to transfer.
+ * @return        : The ioctl return value, negative on failure.
+ */
+int AXI_DMA_Transfer (Channel *channel, int buf_id){
+
+	#ifdef SOBEL_PL_EMULATE
+		return emulator_transfer(channel, buf_id);
+	#else
+		return ioctl(channel->fd, XFER, &buf_id);
+	#endif
+
+}/* end of AXI_DMA_Transfer() */
+
+/*
+ * This function maps the physical address range of an AXI Lite register block
+ * (AxiReg->base, AxiReg->size) into the virtual address space of the process.
+ * @param AxiReg : AXI Lite register data structure.
+ * @return       : SOBEL_SUCCESS on success, SOBEL_FAILURE on failure.
+ */
+int AXILite_Register_Map (AXILite_Register_t * AxiReg){
+
+	#ifdef SOBEL_PL_EMULATE
+		return emulator_register_map(AxiReg);
+	#endif
+
+	int fd = open("/dev/mem", O_RDWR | O_SYNC);
+	if (fd == -1) {
+		return SOBEL_FAILURE;
+	}
+
+	AxiReg->ptr = mmap(NULL, AxiReg->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, AxiReg->base);
+	close(fd);
+
+	if (AxiReg->ptr == MAP_FAILED) {
+		return SOBEL_FAILURE;
+	}
+
+	return SOBEL_SUCCESS;
+}/* end of AXILite_Register_Map() */
+
 /*
  * This function writes data to a memory-mapped AXI Lite register. It writes 
  * 32-bit wide data to virtual memory at the address calculated as (reg + offset).
@@ -42,6 +96,11 @@ int AXI_DMA_Init (Channel *channel){
  */
 void AXILite_Register_Write (AXILite_Register_t * AxiReg, uint32_t offset, uint32_t data) {
 
+    #ifdef SOBEL_PL_EMULATE
+        emulator_register_write(AxiReg, offset, data);
+        return;
+    #endif
+
     AxiReg->ptr[ offset >> 2 ] = ( uint32_t ) data;
 
 }
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "report.h"
+
+static const char *report_mode_name(int mode) {
+    return mode == MODE_CPU ? "cpu" : (mode == MODE_HYBRID ? "hybrid" : "fpga");
+}
+
+static void report_json_string(FILE *fp, const char *s) {
+
+    fputc('"', fp);
+
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\')           { fprintf(fp, "\\%c", *s); }
+        else if ((unsigned char)*s < 0x20)     { fprintf(fp, "\\u%04x", (unsigned char)*s); }
+        else                                   { fputc(*s, fp); }
+    }
+
+    fputc('"', fp);
+}
+
+static void report_csv_string(FILE *fp, const char *s) {
+
+    fputc('"', fp);
+
+    for (; *s; s++) {
+        if (*s == '"') { fputc('"', fp); }
+        fputc(*s, fp);
+    }
+
+    fputc('"', fp);
+}
+
+/*
+ * Function to parse the report format given on the command line.
+ * @param name : "json" or "csv".
+ * @return     : REPORT_JSON, REPORT_CSV, or -1 if unknown.
+ */
+int report_format(const char *name) {
+
+    if (strcmp(name, "json") == 0) { return REPORT_JSON; }
+    if (strcmp(name, "csv")  == 0) { return REPORT_CSV; }
+
+    return -1;
+
+} /* end of report_format() */
+
+/*
+ * Function to reset the aggregated report.
+ * @param report : The report.
+ */
+void report_init(sobel_report_t *report) {
+
+    memset(report, 0, sizeof(*report));
+
+} /* end of report_init() */
+
+/*
+ * Function to snapshot the statistics registers of every IP core instance. The registers
+ * count from the moment the core is enabled, so a frame is measured as the difference of
+ * two snapshots (modulo 2^32).
+ * @param params   : Sobel edge detection data structure.
+ * @param counters : One entry per instance.
+ */
+void report_read_counters(const sobel_edge_detection_t *params, report_counters_t *counters) {
+
+    for (int i = 0; i < params->instances; i++) {
+        counters[i].in     = AXILite_Register_Read(params->inst[i].reg, INPUT_COUNT_REG_OFFSET);
+        counters[i].out    = AXILite_Register_Read(params->inst[i].reg, OUTPUT_COUNT_REG_OFFSET);
+        counters[i].cycles = AXILite_Register_Read(params->inst[i].reg, CLOCK_COUNT_REG_OFFSET);
+    }
+
+} /* end of report_read_counters() */
+
+/*
+ * Function to fold a processed frame into the report.
+ * @param report      : The report.
+ * @param params      : Sobel edge detection data structure (tile layout of the frame).
+ * @param before      : Counter snapshot taken before the frame.
+ * @param after       : Counter snapshot taken after the frame.
+ * @param frame_time  : End-to-end frame time in seconds.
+ * @param fpga_time   : Time the DMA threads took to stream the tiles, in seconds.
+ * @param border_time : Time the PS took to fill in the tile borders, in seconds.
+ * @param cpu_time    : CPU worker time in seconds.
+ */
+void report_frame(sobel_report_t *report, const sobel_edge_detection_t *params, const report_counters_t *before,
+                  const report_counters_t *after, double frame_time, double fpga_time, double border_time, double cpu_time) {
+
+    long tiles = (long)params->tiler.tiles_x * params->tiler.tiles_y;
+    uint32_t busiest = 0;
+
+    for (int i = 0; i < params->instances; i++) {
+
+        uint32_t cycles = after[i].cycles - before[i].cycles;
+
+        report->in_count  += (uint32_t)(after[i].in - before[i].in);
+        report->out_count += (uint32_t)(after[i].out - before[i].out);
+        report->cycles    += cycles;
+
+        if (cycles > busiest) {
+            busiest = cycles;
+        }
+    }
+
+    if (report->frames == 0 || frame_time < report->frame_min) { report->frame_min = frame_time; }
+    if (report->frames == 0 || frame_time > report->frame_max) { report->frame_max = frame_time; }
+
+    report->frames++;
+    report->tiles       += tiles;
+    report->pixels      += (uint64_t)params->Nx * params->Ny;
+    report->fpga_pixels += (uint64_t)tiles * TILE_IN_SIZE;
+    report->fabric_time += (double)busiest / SOBEL_IP_CORE_CLK_HZ;
+    report->proc_time   += frame_time;
+    report->fpga_time   += fpga_time;
+    report->border_time += border_time;
+    report->cpu_time    += cpu_time;
+
+} /* end of report_frame() */
+
+/*
+ * Function to write the aggregated report in the format selected with -r, appended to the
+ * file selected with -o (stdout if none). The host name identifies the board. A run that
+ * stopped on a failed frame is still reported, with integrity false.
+ * @param report : The report.
+ * @param params : Sobel edge detection data structure.
+ * @return       : SOBEL_SUCCESS on success, SOBEL_FAILURE on failure.
+ */
+int report_write(const sobel_report_t *report, const sobel_edge_detection_t *params) {
+
+    char board[64] = "unknown";
+    char stamp[32];
+    time_t now = time(NULL);
+
+    gethostname(board, sizeof(board) - 1);
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    // Derived metrics
+    uint64_t expected_in  = (uint64_t)report->tiles * TILE_IN_SIZE;
+    uint64_t expected_out = (uint64_t)report->tiles * TILE_OUT_SIZE;
+    int integrity = !report->failed && report->in_count == expected_in && report->out_count == expected_out;
+
+    double cycles_per_pixel = report->in_count    ? (double)report->cycles / report->in_count : 0.0;
+    double fabric_mpix      = report->fabric_time > 0.0 ? report->fpga_pixels / report->fabric_time / 1e6 : 0.0;
+    double accel_mpix       = report->fpga_time   > 0.0 ? report->fpga_pixels / report->fpga_time / 1e6 : 0.0;
+    double e2e_mpix         = report->proc_time   > 0.0 ? report->pixels / report->proc_time / 1e6 : 0.0;
+    double dma_overhead     = report->fpga_time   > 0.0 && report->fpga_pixels ? 100.0 * (report->fpga_time - report->fabric_time) / report->fpga_time : 0.0;
+    double frame_mean       = report->frames ? report->proc_time / report->frames : 0.0;
+
+    if (dma_overhead < 0.0) {
+        dma_overhead = 0.0;
+    }
+
+    FILE *fp = stdout;
+    int header = 1;
+
+    if (params->report_file) {
+
+        struct stat st;
+        header = stat(params->report_file, &st) != 0 || st.st_size == 0;
+
+        if (!(fp = fopen(params->report_file, "a"))) {
+            return SOBEL_FAILURE;
+        }
+    }
+
+    if (params->report_format == REPORT_JSON) {
+
+        fprintf(fp, "{\"board\":");          report_json_string(fp, board);
+        fprintf(fp, ",\"timestamp\":\"%s\",\"image\":", stamp);
+        report_json_string(fp, params->Fin);
+        fprintf(fp, ",\"nx\":%d,\"ny\":%d,\"mode\":\"%s\",\"instances\":%d,\"chunk_size\":%d,\"clk_hz\":%.0f",
+                params->Nx, params->Ny, report_mode_name(params->mode), params->instances, CHUNK_SIZE_PER_TRANSFER, (double)SOBEL_IP_CORE_CLK_HZ);
+        fprintf(fp, ",\"frames\":%d,\"tiles\":%ld,\"pixels\":%llu,\"fpga_pixels\":%llu",
+                report->frames, report->tiles, (unsigned long long)report->pixels, (unsigned long long)report->fpga_pixels);
+        fprintf(fp, ",\"input_count\":%llu,\"output_count\":%llu,\"expected_input_count\":%llu,\"expected_output_count\":%llu,\"integrity\":%s",
+                (unsigned long long)report->in_count, (unsigned long long)report->out_count,
+                (unsigned long long)expected_in, (unsigned long long)expected_out, integrity ? "true" : "false");
+        fprintf(fp, ",\"cycles\":%llu,\"cycles_per_pixel\":%.4f,\"fabric_mpix_s\":%.3f,\"accel_mpix_s\":%.3f,\"end_to_end_mpix_s\":%.3f,\"dma_overhead_pct\":%.2f",
+                (unsigned long long)report->cycles, cycles_per_pixel, fabric_mpix, accel_mpix, e2e_mpix, dma_overhead);
+        fprintf(fp, ",\"frame_ms_mean\":%.3f,\"frame_ms_min\":%.3f,\"frame_ms_max\":%.3f,\"fpga_ms\":%.3f,\"border_ms\":%.3f,\"cpu_ms\":%.3f}\n",
+                frame_mean * 1e3, report->frame_min * 1e3, report->frame_max * 1e3, report->fpga_time * 1e3, report->border_time * 1e3, report->cpu_time * 1e3);
+
+    } else {
+
+        if (header) {
+            fprintf(fp, "board,timestamp,image,nx,ny,mode,instances,chunk_size,clk_hz,frames,tiles,pixels,fpga_pixels,"
+                        "input_count,output_count,expected_input_count,expected_output_count,integrity,"
+                        "cycles,cycles_per_pixel,fabric_mpix_s,accel_mpix_s,end_to_end_mpix_s,dma_overhead_pct,"
+                        "frame_ms_mean,frame_ms_min,frame_ms_max,fpga_ms,border_ms,cpu_ms\n");
+        }
+
+        report_csv_string(fp, board);
+        fprintf(fp, ",%s,", stamp);
+        report_csv_string(fp, params->Fin);
+        fprintf(fp, ",%d,%d,%s,%d,%d,%.0f,%d,%ld,%llu,%llu,%llu,%llu,%llu,%llu,%d,%llu,%.4f,%.3f,%.3f,%.3f,%.2f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n",
+                params->Nx, params->Ny, report_mode_name(params->mode), params->instances,
+                CHUNK_SIZE_PER_TRANSFER, (double)SOBEL_IP_CORE_CLK_HZ, report->frames, report->tiles,
+                (unsigned long long)report->pixels, (unsigned long long)report->fpga_pixels,
+                (unsigned long long)report->in_count, (unsigned long long)report->out_count,
+                (unsigned long long)expected_in, (unsigned long long)expected_out, integrity,
+                (unsigned long long)report->cycles, cycles_per_pixel, fabric_mpix, accel_mpix, e2e_mpix, dma_overhead,
+                frame_mean * 1e3, report->frame_min * 1e3, report->frame_max * 1e3, report->fpga_time * 1e3, report->border_time * 1e3, report->cpu_time * 1e3);
+    }
+
+    if (fp != stdout) {
+        fclose(fp);
+    }
+
+    return SOBEL_SUCCESS;
+
+} /* end of report_write() */
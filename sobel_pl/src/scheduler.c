@@ -0,0 +1,137 @@
+#include <pthread.h>
+
+#include "scheduler.h"
+
+/*
+ * Function to initialise the shared tile queue of a frame. Every IP core instance pulls
+ * its next tile from this queue as soon as its TX thread is free, so faster (or less
+ * loaded) instances naturally take more tiles.
+ * @param queue : The tile queue.
+ * @param count : Number of tiles in the frame.
+ */
+void tile_queue_init(tile_queue_t *queue, int count) {
+
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+
+    queue->next = 0;
+    queue->count = count;
+    queue->halt = 0;
+
+} /* end of tile_queue_init() */
+
+/*
+ * Function to release the synchronisation objects of the tile queue.
+ * @param queue : The tile queue.
+ */
+void tile_queue_destroy(tile_queue_t *queue) {
+
+    pthread_cond_destroy(&queue->cond);
+    pthread_mutex_destroy(&queue->lock);
+
+} /* end of tile_queue_destroy() */
+
+/*
+ * Function to take the next tile from the shared queue.
+ * @param queue : The tile queue.
+ * @return      : The tile index, or -1 when the frame is done or halted.
+ */
+int tile_queue_next(tile_queue_t *queue) {
+
+    int tile = -1;
+
+    pthread_mutex_lock(&queue->lock);
+
+    if (!queue->halt && queue->next < queue->count) {
+        tile = queue->next++;
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return tile;
+
+} /* end of tile_queue_next() */
+
+/*
+ * Function to stop all instances after an error. Threads blocked on a tile FIFO are woken up.
+ * @param queue : The tile queue.
+ */
+void tile_queue_halt(tile_queue_t *queue) {
+
+    pthread_mutex_lock(&queue->lock);
+    queue->halt = 1;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->lock);
+
+} /* end of tile_queue_halt() */
+
+/*
+ * Function to empty the in-flight FIFO of an instance.
+ * @param fifo : The tile FIFO.
+ */
+void tile_fifo_init(tile_fifo_t *fifo) {
+
+    fifo->head = 0;
+    fifo->count = 0;
+
+} /* end of tile_fifo_init() */
+
+/*
+ * Function to record, from the TX thread, that a tile is being streamed to the instance.
+ * @param queue : The tile queue (provides the lock and the halt flag).
+ * @param fifo  : The tile FIFO of the instance.
+ * @param tile  : The tile index, or -1 to mark the end of the frame.
+ * @return      : 0 on success, -1 if the frame was halted.
+ */
+int tile_fifo_push(tile_queue_t *queue, tile_fifo_t *fifo, int tile) {
+
+    int ret = 0;
+
+    pthread_mutex_lock(&queue->lock);
+
+    while (!queue->halt && fifo->count == TILE_FIFO_DEPTH) {
+        pthread_cond_wait(&queue->cond, &queue->lock);
+    }
+
+    if (queue->halt) {
+        ret = -1;
+    } else {
+        fifo->tiles[(fifo->head + fifo->count) % TILE_FIFO_DEPTH] = tile;
+        fifo->count++;
+        pthread_cond_broadcast(&queue->cond);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return ret;
+
+} /* end of tile_fifo_push() */
+
+/*
+ * Function to get, in the RX thread, the tile whose output the instance returns next.
+ * @param queue : The tile queue (provides the lock and the halt flag).
+ * @param fifo  : The tile FIFO of the instance.
+ * @return      : The tile index, or -1 at the end of the frame or if it was halted.
+ */
+int tile_fifo_pop(tile_queue_t *queue, tile_fifo_t *fifo) {
+
+    int tile = -1;
+
+    pthread_mutex_lock(&queue->lock);
+
+    while (!queue->halt && fifo->count == 0) {
+        pthread_cond_wait(&queue->cond, &queue->lock);
+    }
+
+    if (!queue->halt) {
+        tile = fifo->tiles[fifo->head];
+        fifo->head = (fifo->head + 1) % TILE_FIFO_DEPTH;
+        fifo->count--;
+        pthread_cond_broadcast(&queue->cond);
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return tile;
+
+} /* end of tile_fifo_pop() */
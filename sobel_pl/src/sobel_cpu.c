@@ -0,0 +1,138 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "sobel_cpu.h"
+
+/*
+ * Manhattan magnitude of the 3x3 neighbourhood (columns l, x, r) of rows t, m, b,
+ * saturated at 255 exactly like manhattan_norm.vhd.
+ */
+static inline uint8_t sobel_cpu_pixel(const uint8_t *t, const uint8_t *m, const uint8_t *b, int l, int x, int r) {
+
+    int sx = (t[r] - t[l]) + 2 * (m[r] - m[l]) + (b[r] - b[l]);
+    int sy = (b[l] + 2 * b[x] + b[r]) - (t[l] + 2 * t[x] + t[r]);
+
+    int magnitude = abs(sx) + abs(sy);
+    return magnitude > 255 ? 255 : magnitude;
+}
+
+/*
+ * Vector kernel written once with the GCC/Clang vector extensions: one register of 16-bit lanes,
+ * which the compiler maps to NEON on the Cortex-A9 (-mfpu=neon), to SSE2 or AVX2 on x86, and to
+ * plain code where there is no SIMD unit. make SCALAR=1 builds the scalar loop instead, to check
+ * bit-exactness against it.
+ */
+#if !defined(SOBEL_CPU_SCALAR) && (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 9))
+#define SOBEL_CPU_VECTOR
+#if defined(__AVX2__)
+#define SOBEL_CPU_LANES 16
+#else
+#define SOBEL_CPU_LANES 8                       // 128-bit NEON / SSE2 registers
+#endif
+
+typedef uint8_t sobel_u8v __attribute__((vector_size(SOBEL_CPU_LANES)));
+typedef int16_t sobel_i16v __attribute__((vector_size(2 * SOBEL_CPU_LANES)));
+
+static inline sobel_i16v sobel_cpu_load(const uint8_t *p) {
+
+    sobel_u8v v;
+    memcpy(&v, p, sizeof(v));                   // unaligned load
+    return __builtin_convertvector(v, sobel_i16v);
+}
+
+static inline sobel_i16v sobel_cpu_abs(sobel_i16v v) {
+
+    sobel_i16v sign = v >> 15;
+    return (v ^ sign) - sign;
+}
+
+/*
+ * Output pixels [x, x + SOBEL_CPU_LANES) of rows t, m, b; columns x - 1 to x + SOBEL_CPU_LANES
+ * must exist.
+ */
+static inline void sobel_cpu_block(const uint8_t *t, const uint8_t *m, const uint8_t *b, int x, uint8_t *o) {
+
+    sobel_i16v tl = sobel_cpu_load(t + x - 1), tx = sobel_cpu_load(t + x), tr = sobel_cpu_load(t + x + 1);
+    sobel_i16v ml = sobel_cpu_load(m + x - 1),                              mr = sobel_cpu_load(m + x + 1);
+    sobel_i16v bl = sobel_cpu_load(b + x - 1), bx = sobel_cpu_load(b + x), br = sobel_cpu_load(b + x + 1);
+
+    sobel_i16v sx = (tr - tl) + ((mr - ml) << 1) + (br - bl);
+    sobel_i16v sy = (bl + (bx << 1) + br) - (tl + (tx << 1) + tr);
+
+    // |Gx| + |Gy| <= 2040 fits the lanes; saturate at 255 without a compare
+    sobel_i16v magnitude = sobel_cpu_abs(sx) + sobel_cpu_abs(sy);
+    sobel_i16v over = magnitude - 255;
+    magnitude -= over & ~(over >> 15);
+
+    sobel_u8v result = __builtin_convertvector(magnitude, sobel_u8v);
+    memcpy(o + x, &result, sizeof(result));
+}
+#endif
+
+/*
+ * Sobel (Manhattan norm) of the output pixels [x0, x1) of one row, from the rows above (t),
+ * at (m) and below (b) it. Columns x0 - 1 to x1 must exist in all three rows. The bulk of
+ * the row goes through the vector kernel above, its remainder pixel by pixel.
+ * @param t  : Row above.
+ * @param m  : Current row.
+ * @param b  : Row below.
+ * @param o  : Output row.
+ * @param x0 : First column to compute.
+ * @param x1 : One past the last column to compute.
+ */
+void sobel_cpu_row(const uint8_t *t, const uint8_t *m, const uint8_t *b, uint8_t *o, int x0, int x1) {
+
+    int x = x0;
+
+#ifdef SOBEL_CPU_VECTOR
+    for (; x + SOBEL_CPU_LANES <= x1; x += SOBEL_CPU_LANES) {
+        sobel_cpu_block(t, m, b, x, o);
+    }
+#endif
+
+    for (; x < x1; x++) {
+        o[x] = sobel_cpu_pixel(t, m, b, x - 1, x, x + 1);
+    }
+
+} /* end of sobel_cpu_row() */
+
+/*
+ * Software Sobel (Manhattan norm) on the PS cores. Computes the output pixels of the
+ * rectangle [x0, x1) x [y0, y1) of an Nx x Ny image. Neighbours outside the image are
+ * replicated from the nearest edge, as in sobel_software. The interior of every row goes
+ * through sobel_cpu_row(), the border columns pixel by pixel.
+ * @param in  : Input image (Nx * Ny bytes).
+ * @param out : Output image (Nx * Ny bytes).
+ * @param Nx  : Image columns.
+ * @param Ny  : Image rows.
+ * @param x0  : First column to compute.
+ * @param y0  : First row to compute.
+ * @param x1  : One past the last column to compute.
+ * @param y1  : One past the last row to compute.
+ */
+void sobel_cpu_manhattan(const uint8_t *in, uint8_t *out, int Nx, int Ny, int x0, int y0, int x1, int y1) {
+
+    for (int y = y0; y < y1; y++) {
+
+        const uint8_t *t = in + (size_t)(y > 0 ? y - 1 : 0) * Nx;         // row above (clamped)
+        const uint8_t *m = in + (size_t)y * Nx;                           // current row
+        const uint8_t *b = in + (size_t)(y < Ny - 1 ? y + 1 : Ny - 1) * Nx; // row below (clamped)
+        uint8_t *o = out + (size_t)y * Nx;
+
+        int xs = x0, xe = x1;
+
+        // Left and right image columns replicate their missing neighbour
+        if (xs == 0 && xe > 0) {
+            o[0] = sobel_cpu_pixel(t, m, b, 0, 0, Nx > 1 ? 1 : 0);
+            xs = 1;
+        }
+        if (xe == Nx && xe > xs) {
+            o[Nx - 1] = sobel_cpu_pixel(t, m, b, Nx - 2, Nx - 1, Nx - 1);
+            xe = Nx - 1;
+        }
+
+        sobel_cpu_row(t, m, b, o, xs, xe);
+    }
+
+} /* end of sobel_cpu_manhattan() */
@@ -1,12 +1,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <string.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
+#include <sys/time.h>
 #include <sys/param.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
 #include "sobel_pl.h"
+#include "report.h"
 
 /*
  * Function to retrieve and validate user input.
@@ -17,16 +21,70 @@
  */
 int get_input(int argc, char *argv[], sobel_edge_detection_t *params) {
 
-    if (argc < 5) {
-        printf("Usage   : %s <FIN> <FOUT> <NX> <NY> \n\n", argv[0]);
+    int opt;
+
+    params->mode = MODE_FPGA;
+    params->frames = 1;
+    params->instances = 1;
+    params->trace_file = NULL;
+    params->report_format = REPORT_NONE;
+    params->report_file = NULL;
+
+    while ((opt = getopt(argc, argv, "m:n:c:t:r:o:")) != -1) {
+
+        switch (opt) {
+
+            case 'm':
+                if      (strcmp(optarg, "fpga")   == 0) { params->mode = MODE_FPGA; }
+                else if (strcmp(optarg, "cpu")    == 0) { params->mode = MODE_CPU; }
+                else if (strcmp(optarg, "hybrid") == 0) { params->mode = MODE_HYBRID; }
+                else                                    { params->mode = -1; }
+                break;
+
+            case 'n':
+                params->frames = atoi(optarg);
+                break;
+
+            case 'c':
+                params->instances = atoi(optarg);
+                break;
+
+            case 't':
+                params->trace_file = optarg;
+                break;
+
+            case 'r':
+                params->report_format = report_format(optarg);
+                break;
+
+            case 'o':
+                params->report_file = optarg;
+                break;
+
+            default:
+                params->mode = -1;
+                break;
+        }
+    }
+
+    if (argc - optind < 4 || params->mode < 0 || params->frames <= 0 || params->instances <= 0 || params->instances > SOBEL_MAX_INSTANCES || params->report_format < 0) {
+        printf("Usage   : %s [-m fpga|cpu|hybrid] [-n FRAMES] [-c CORES] [-t TRACE] [-r json|csv] [-o REPORT] <FIN> <FOUT> <NX> <NY> \n\n", argv[0]);
         printf("  FIN  : Path to the 8-bit input grayscale raw image \n");
         printf("  FOUT : Path to the 8-bit output grayscale raw image \n");
-        printf("  NX   : Horizontal image dimension \n");
-        printf("  NY   : Vertical image dimension \n");
+        printf("  NX   : Horizontal image dimension (any size, tiled to the IP core frame) \n");
+        printf("  NY   : Vertical image dimension (any size, tiled to the IP core frame) \n");
+        printf("  -m   : Processing engine; hybrid splits every frame between the IP core and the CPU (default fpga) \n");
+        printf("  -n   : Number of times the frame is processed (default 1) \n");
+        printf("  -c   : Number of Sobel IP core instances the tiles are dispatched to (1 to %d, default 1) \n", SOBEL_MAX_INSTANCES);
+        printf("  -t   : Write a Chrome trace-event JSON timeline of the DMA threads to TRACE \n");
+        printf("  -r   : Print a machine-readable performance report aggregated over all frames \n");
+        printf("  -o   : Append the report to REPORT instead of printing it \n");
         
         return SOBEL_FAILURE;
     }
 
+    argv += optind - 1;
+
     printf("[STATUS] Checking the inputs \n");
 
     // Input file name
@@ -122,6 +180,8 @@ int get_input(int argc, char *argv[], sobel_edge_detection_t *params) {
  */
 int setup(sobel_edge_detection_t *params) {
 
+    #ifndef SOBEL_PL_EMULATE
+
     #ifdef IS_VERBOSE 
         printf("[STATUS] Inserting dma-proxy.ko driver module\n");
     #endif 
@@ -133,145 +193,367 @@ int setup(sobel_edge_detection_t *params) {
     system("sudo rmmod -w /lib/modules/xilinx/extra/dma-proxy.ko > /dev/null 2>&1");
     system("sudo insmod /lib/modules/xilinx/extra/dma-proxy.ko > /dev/null 2>&1");
 
-    #ifdef IS_VERBOSE
-        printf("[STATUS] Initializing the DMA channels\n");
     #endif
 
-    // Setup the DMA channels
-	params->tx_channel = (Channel *)malloc(sizeof(Channel));
-	params->rx_channel = (Channel *)malloc(sizeof(Channel));
+    // Trace buffers are allocated up front, so the DMA threads never allocate: TX records
+    // a gather and a transfer per tile, RX a transfer and a scatter per chunk
+    sobel_tiler_t frame;
+    tiler_init(&frame, params->Nx, params->Ny, 0, params->Ny);
+
+    uint64_t tiles = params->mode == MODE_CPU ? 0 : (uint64_t)frame.tiles_x * frame.tiles_y * params->frames;
+    uint64_t chunks = (TILE_OUT_SIZE + CHUNK_SIZE_PER_TRANSFER - 1) / CHUNK_SIZE_PER_TRANSFER;
+
+    // Instances take tiles from one shared queue, so each records about its share of them. A
+    // quarter more covers uneven instances; events past that are reported as dropped
+    uint64_t share = (tiles + params->instances - 1) / params->instances;
+    share = share + share / 4 < tiles ? share + share / 4 : tiles;
+
+    trace_init(&params->trace, "main", 2);
+
+    params->inst = (sobel_instance_t *)calloc(params->instances, sizeof(sobel_instance_t));
+
+    if (!params->inst) {
+
+        #ifdef IS_VERBOSE
+            printf("[ERROR] Failed to allocate memory for the IP core instances \n");
+        #endif
+
+        return SOBEL_FAILURE;
+    }
+
+    for (int i = 0; i < params->instances; i++) {
+
+        sobel_instance_t *inst = &params->inst[i];
+        char name[32];
+
+        snprintf(name, sizeof(name), "core %d TX", i);
+        trace_init(&inst->tx_trace, name, 2 * share);
+
+        snprintf(name, sizeof(name), "core %d RX", i);
+        trace_init(&inst->rx_trace, name, 2 * chunks * share);
+
+        #ifdef IS_VERBOSE
+            printf("[STATUS] Initializing the DMA channels of instance %d\n", i);
+        #endif
+
+        // Setup the DMA channels
+        inst->tx_channel = (Channel *)malloc(sizeof(Channel));
+        inst->rx_channel = (Channel *)malloc(sizeof(Channel));
+
+        inst->tx_channel->name = (char *)malloc(32);
+        inst->rx_channel->name = (char *)malloc(32);
+
+        snprintf(inst->tx_channel->name, 32, DMA_TX_CHANNEL_NAME, i);
+        snprintf(inst->rx_channel->name, 32, DMA_RX_CHANNEL_NAME, i);
+
+        // Activate the AXI DMA IP core
+        if (AXI_DMA_Init(inst->tx_channel) || AXI_DMA_Init(inst->rx_channel)) {
+           
+            #ifdef IS_VERBOSE   
+                printf("[ERROR] Cannot initialize the DMA channels %s / %s \n", inst->tx_channel->name, inst->rx_channel->name);
+                printf("[STATUS] Exiting with failures \n");
+            #endif
+
+            return SOBEL_FAILURE;
+
+        }
+
+        #ifdef IS_VERBOSE 
+            printf("[STATUS] Setting up the AXI4-Lite Sobel Edge Detector interface \n");
+        #endif 
+
+        // Map the AXI Sobel Edge Detector registers 
+        inst->reg = (AXILite_Register_t *)malloc(sizeof(AXILite_Register_t));
+        
+        inst->reg->size = SOBEL_IP_CORE_REG_SIZE;
+        inst->reg->base = SOBEL_IP_CORE_REG_BASE + i * SOBEL_IP_CORE_REG_STRIDE;
+
+        if (AXILite_Register_Map(inst->reg) != SOBEL_SUCCESS) {
+
+            #ifdef IS_VERBOSE
+                printf("[ERROR] Cannot map the Sobel IP core registers \n");
+                printf("[STATUS] Exiting with failure \n");
+            #endif
+
+            return SOBEL_FAILURE;
+
+        }
+        
+        #ifdef IS_VERBOSE
+            printf("[INFO] Register Address Space Size : %d Bytes \n", inst->reg->size);
+            printf("[INFO] Register Physical Address   : 0x%x \n", inst->reg->base);
+            printf("[INFO] Register Mapped Address     : 0x%x \n", inst->reg->ptr);
+            printf("[STATUS] Enabling the Sobel Edge Detector IP core\n");
+        #endif
+
+        // Disable the core if already is enabled and then enable it
+        AXILite_Register_Write(inst->reg, ENABLE_REG_OFFSET, 0x00);
+        AXILite_Register_Write(inst->reg, ENABLE_REG_OFFSET, 0x01);
+
+        // verify that the register is written
+        if ( AXILite_Register_Read(inst->reg, ENABLE_REG_OFFSET) != 1 ) {
+
+            #ifdef IS_VERBOSE
+                printf("[ERROR] Reg@[0x%x + 0x%x] cannot be written \n", inst->reg->base, ENABLE_REG_OFFSET);
+                printf("[STATUS] Exiting with failure \n");
+            #endif
+
+            return SOBEL_FAILURE;
+
+        }
+    }
+
+    return SOBEL_SUCCESS;
+
+} /* end of setup()*/
+
+/*
+ * Function to stage the input and output images for the DMA threads. The input file is 
+ * mapped and populated in full with readahead, and the output file is sized and mapped 
+ * shared, so the RX thread scatters straight into the page cache and no file system call
+ * sits on the DMA path. If a file cannot be mapped, it falls back to a DRAM copy that is 
+ * read here and written by store_image().
+ * @param params : Sobel edge detection data structure.
+ * @return       : SOBEL_SUCCESS on success, SOBEL_FAILURE on failure.
+ */
+int load_image(sobel_edge_detection_t *params) {
 
-    params->tx_channel->name = (char *)DMA_TX_CHANNEL_NAME;
-    params->rx_channel->name = (char *)DMA_RX_CHANNEL_NAME;
+    size_t N = (size_t)params->Nx * params->Ny;
+    struct stat st;
 
-    // Activate the AXI DMA IP core
-    if (AXI_DMA_Init(params->tx_channel) || AXI_DMA_Init(params->rx_channel)) {
-       
-        #ifdef IS_VERBOSE   
-            printf("[ERROR] Cannot initialize the DMA channels \n");
-            printf("[STATUS] Exiting with failures \n");
+    params->in_mapped = 0;
+    params->out_mapped = 0;
+
+    if ( (params->fdi = open(params->Fin, O_RDONLY)) == -1) {
+
+        #ifdef IS_VERBOSE
+            printf("[ERROR] Unable to open input file \n");
         #endif
 
         return SOBEL_FAILURE;
+    }
+
+    if (fstat(params->fdi, &st) == 0 && S_ISREG(st.st_mode) && (size_t)st.st_size < N) {
+
+        #ifdef IS_VERBOSE
+            printf("[ERROR] Input file holds %zu of %zu bytes \n", (size_t)st.st_size, N);
+        #endif
+
+        close(params->fdi);
 
+        return SOBEL_FAILURE;
     }
 
-    #ifdef IS_VERBOSE 
-        printf("[STATUS] Setting up the AXI4-Lite Sobel Edge Detector interface \n");
-    #endif 
+    uint64_t t_start = trace_now();
 
-    // Map the AXI Sobel Edge Detector registers 
-	int fd = open("/dev/mem", O_RDWR | O_SYNC); 
-    
-    params->reg = (AXILite_Register_t *)malloc(sizeof(AXILite_Register_t));
-    
-    params->reg->size = SOBEL_IP_CORE_REG_SIZE;
-    params->reg->base = SOBEL_IP_CORE_REG_BASE;
-    params->reg->ptr = mmap(NULL, params->reg->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, params->reg->base);
-    
-    #ifdef IS_VERBOSE
-        printf("[INFO] Register Address Space Size : %d Bytes \n", params->reg->size);
-        printf("[INFO] Register Physical Address   : 0x%x \n", params->reg->base);
-        printf("[INFO] Register Mapped Address     : 0x%x \n", params->reg->ptr);
-        printf("[STATUS] Enabling the Sobel Edge Detector IP core\n");
-    #endif
+    // Map the whole input, fault it in now and ask for readahead of what may still be missing
+    params->in_image = (uint8_t *)mmap(NULL, N, PROT_READ, MAP_PRIVATE | MAP_POPULATE, params->fdi, 0);
+
+    if (params->in_image != MAP_FAILED) {
+
+        madvise(params->in_image, N, MADV_WILLNEED);
+        params->in_mapped = 1;
+
+    } else if ((params->in_image = (uint8_t *)malloc(N)) != NULL) {
+
+        size_t n_read = 0;
+        while (n_read < N) {
+
+            ssize_t n = read(params->fdi, params->in_image + n_read, N - n_read);
+            if (n <= 0) {
+
+                #ifdef IS_VERBOSE
+                    printf("[ERROR] Input file holds %zu of %zu bytes \n", n_read, N);
+                #endif
+
+                close(params->fdi);
+
+                return SOBEL_FAILURE;
+            }
+
+            n_read += n;
+        }
+    }
+
+    close(params->fdi);
+
+    if (!params->in_image) {
+
+        #ifdef IS_VERBOSE
+            printf("[ERROR] Failed to allocate memory for the input image \n");
+        #endif
+
+        return SOBEL_FAILURE;
+    }
 
-    // Disable the core if already is enabled and then enable it
-    AXILite_Register_Write(params->reg, ENABLE_REG_OFFSET, 0x00);
-    AXILite_Register_Write(params->reg, ENABLE_REG_OFFSET, 0x01);
+    trace_record(&params->trace, TRACE_LOAD, t_start, trace_now(), -1);
 
-    // verify that the register is written
-    if ( AXILite_Register_Read(params->reg, ENABLE_REG_OFFSET) != 1 ) {
+    // Size the output file and map it, so the processed image is written in place
+    if ( (params->fdo = open(params->Fout, O_RDWR | O_CREAT | O_TRUNC, 0644)) == -1) {
 
         #ifdef IS_VERBOSE
-            printf("[ERROR] Reg@[0x%x + 0x%x] cannot be written \n", params->reg->base, ENABLE_REG_OFFSET);
-            printf("[STATUS] Exiting with failure \n");
+            printf("[ERROR] Unable to open output file \n");
         #endif
 
-        close(fd);
+        return SOBEL_FAILURE;
+    }
+
+    if (ftruncate(params->fdo, N) == 0) {
+
+        params->out_image = (uint8_t *)mmap(NULL, N, PROT_READ | PROT_WRITE, MAP_SHARED, params->fdo, 0);
+        params->out_mapped = params->out_image != MAP_FAILED;
+    }
+
+    close(params->fdo);
+
+    if (!params->out_mapped && !(params->out_image = (uint8_t *)malloc(N))) {
+
+        #ifdef IS_VERBOSE
+            printf("[ERROR] Failed to allocate memory for the output image \n");
+        #endif
 
         return SOBEL_FAILURE;
+    }
 
+    return SOBEL_SUCCESS;
+
+} /* end of load_image() */
+
+/*
+ * Function to complete the output image. A mapped output is already in the page cache and is
+ * written back by the kernel; a DRAM copy is written to the MMC here.
+ * @param params : Sobel edge detection data structure.
+ * @return       : SOBEL_SUCCESS on success, SOBEL_FAILURE on failure.
+ */
+int store_image(sobel_edge_detection_t *params) {
+
+    size_t N = (size_t)params->Nx * params->Ny;
+
+    if (params->out_mapped) {
+        return SOBEL_SUCCESS;
     }
 
-    close(fd);
+    if ( (params->fdo = open(params->Fout, O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1) {
+
+        #ifdef IS_VERBOSE
+            printf("[ERROR] Unable to open output file \n");
+        #endif
+
+        return SOBEL_FAILURE;
+    }
+
+    uint64_t t_start = trace_now();
+
+    size_t n_write = 0;
+    while (n_write < N) {
+
+        ssize_t n = write(params->fdo, params->out_image + n_write, N - n_write);
+        if (n <= 0) {
+
+            #ifdef IS_VERBOSE
+                printf("[ERROR] Return value from output file: %zd \n", n);
+            #endif
+
+            close(params->fdo);
+
+            return SOBEL_FAILURE;
+        }
+
+        n_write += n;
+    }
+
+    close(params->fdo);
+
+    trace_record(&params->trace, TRACE_STORE, t_start, trace_now(), -1);
 
     return SOBEL_SUCCESS;
 
-} /* end of setup()*/
+} /* end of store_image() */
+
+/*
+ * Function to unmap or free the input and output images.
+ * @param params : Sobel edge detection data structure.
+ */
+void release_image(sobel_edge_detection_t *params) {
+
+    size_t N = (size_t)params->Nx * params->Ny;
+
+    if (params->in_mapped) { munmap(params->in_image, N); }  else { free(params->in_image); }
+    if (params->out_mapped) { munmap(params->out_image, N); } else { free(params->out_image); }
+
+} /* end of release_image() */
 
 /*
  * Function to create the Sobel DMA controller threads
  * @param thread_args   : The thread arguments.
  * @param channel       : The DMA channel.
  * @param handler       : The thread handler function.
- * @param file          : The file to use (read or write).
+ * @param tiler         : The tile layout of the image.
+ * @param image         : The image to gather from (TX) or scatter into (RX).
+ * @param queue         : The tile queue shared by all instances.
+ * @param inflight      : The tile FIFO between the TX and the RX thread of the instance.
+ * @param trace         : The trace buffer the thread records its chunk timing into.
  * @param transfer_size : The data size to transfer.
- * @param total_size    : The total data size. 
  */
-void create_thread(dma_thread_args_t *thread_args, Channel *channel, void *handler, char *file, int transfer_size, int total_size) {
+void create_thread(dma_thread_args_t *thread_args, Channel *channel, void *handler, sobel_tiler_t *tiler, uint8_t *image, tile_queue_t *queue, tile_fifo_t *inflight, trace_buffer_t *trace, int transfer_size) {
 
     thread_args->channel = channel;
-    thread_args->file = file;
+    thread_args->tiler = tiler;
+    thread_args->image = image;
+    thread_args->queue = queue;
+    thread_args->inflight = inflight;
+    thread_args->trace = trace;
     thread_args->transfer_size = transfer_size;
-    thread_args->total_size = total_size;
+    thread_args->status = SOBEL_SUCCESS;
 
     pthread_create(&channel->tid, NULL, handler, (void *)thread_args);
 } /* end of create_thread() */
 
 /*
- * TX thread. Reads the input image file stored in the MMC to DRAM and then 
- * issues DMA transfer requests from PS to PL through the AXI DMA IP Core in chunks of N bytes at a time.
+ * TX thread. Takes tiles from the shared queue, gathers them from the input image in DRAM 
+ * and issues one DMA transfer request per tile from PS to PL through the AXI DMA IP Core.
+ * The AXI DMA asserts tlast at the end of every MM2S transfer and the window buffer of the
+ * core resets its row and column counters on it, so a tile must never be split over several
+ * transfers. Tiles are streamed back to back, so the core works on tile k while tile k+1 
+ * is sent. Every tile is recorded in the in-flight FIFO before it is streamed, so the RX 
+ * thread of the same instance knows where its output belongs.
  * @param args : The list of worker arguments.
  */
 void *ps2pl(void *args) {
-    int fi, buf_id = 0;
+    int buf_id = 0;
 
 	dma_thread_args_t *thread_args = (dma_thread_args_t *)args;  
 
-    // Open the input file
-    if ( (fi = open(thread_args->file, O_RDONLY)) == -1) {
-        
-        #ifdef IS_VERBOSE
-            printf("[ERROR] Unable to open input file \n");
-            printf("[STATUS] Exiting with failure! \n");
-        #endif
-
-        thread_args->status = SOBEL_FAILURE;
-
-        return NULL;
-    }
-
-    uint32_t n_read = 0;  								// Total number of bytes read from the input file
-    uint32_t transfer = thread_args->transfer_size;  	// Size of each DMA transfer
-    uint32_t total = thread_args->total_size;  			// Total size of data to be transferred
+    uint32_t offset;  									// Offset of the tile in the tile stream
+    int tile;  											// Tile being streamed
+    uint64_t t0, t1;  									// Transfer timestamps
 
     Channel *channel = thread_args->channel;
 	
-    while ( n_read < total ) {
+    while ( (tile = tile_queue_next(thread_args->queue)) >= 0 ) {
 
-	    // Adjust the transfer size if remaining data is less than the transfer size.
-        if (transfer > (total - n_read)) {
-            transfer = total - n_read;
+        if (tile_fifo_push(thread_args->queue, thread_args->inflight, tile) < 0) {
+            break;  // another instance failed
         }
 
-        // Read data from the input file into the buffer.
-        uint32_t n = read(fi, channel->buf_ptr[buf_id].buffer, transfer);
-        if (n <= 0) {
-            
-            #ifdef IS_VERBOSE
-                printf("[WARN] Return value from input file: %d \n", n);
-                printf("[STATUS] Terminating the thread\n");
-            #endif
-             
-            break;
-        }
+        offset = (uint32_t)tile * TILE_IN_SIZE;
+
+        // Copy the tile into the buffer.
+        t0 = trace_now();
+        tiler_gather(thread_args->tiler, thread_args->image, offset, (uint8_t *)channel->buf_ptr[buf_id].buffer, TILE_IN_SIZE);
+        t1 = trace_now();
+
+        trace_record(thread_args->trace, TRACE_GATHER, t0, t1, tile);
 
-        channel->buf_ptr[buf_id].length = n;  // Set the length of the data in the buffer
-        n_read += n;  						  // Update the total number of bytes read
+        channel->buf_ptr[buf_id].length = TILE_IN_SIZE;  // Set the length of the data in the buffer
 
         // Start the DMA transfer from PS to PL (blocking)
-        if (ioctl(channel->fd, XFER, &buf_id) < 0) {
+        int ret = AXI_DMA_Transfer(channel, buf_id);
+        t0 = trace_now();
+
+        trace_record(thread_args->trace, ret < 0 || channel->buf_ptr[buf_id].status != PROXY_NO_ERROR ? TRACE_ERROR : TRACE_XFER, t1, t0, tile);
+
+        if (ret < 0) {
             
             #ifdef IS_VERBOSE 
                 printf("[ERROR] PS to PL DMA transfer failed \n");
@@ -279,7 +561,7 @@ void *ps2pl(void *args) {
             #endif
 
             thread_args->status = SOBEL_FAILURE;
-            close(fi);
+            tile_queue_halt(thread_args->queue);
             
             return NULL;
         }
@@ -293,114 +575,98 @@ void *ps2pl(void *args) {
             #endif 
 
             thread_args->status = SOBEL_FAILURE; 
-            close(fi);
+            tile_queue_halt(thread_args->queue);
 
             return NULL;
         }
-
     }
 
+    // Tell the RX thread that no more tiles follow
+    tile_fifo_push(thread_args->queue, thread_args->inflight, -1);
+
     #ifdef IS_VERBOSE
         printf("[STATUS] PS to PL Thread terminated! \n");
     #endif
 
-    close(fi);
-
-    thread_args->status = SOBEL_SUCCESS;
-
     return NULL;
 
 } /* end of ps2pl() */
 
 /*
  * RX thread. Issues DMA transfer requests to the S2MM interface of the DMA IP Core,
- * reads processed edge data from the Sobel edge detector IP Core, and writes the data 
- * in chunks of N bytes to MMC. 
+ * reads processed edge data from the Sobel edge detector IP Core in chunks of N bytes,
+ * and scatters the valid part of every tile into the output image in DRAM. The tiles
+ * come back in the order the TX thread of the same instance streamed them.
  * @param args : The list of worker arguments.
  */
 void *pl2ps(void *args) {
-    int fo, buf_id = 0;  
+    int buf_id = 0;  
 
     dma_thread_args_t *thread_args = (dma_thread_args_t *)args; 
 
-    if ( (fo = open(thread_args->file, O_WRONLY | O_CREAT | O_TRUNC, 0644)) == -1) {
-        
-        #ifdef IS_VERBOSE
-            printf("[ERROR] Unable to open output file \n");
-            printf("[STATUS] Exiting with failure! \n");
-        #endif
-
-        thread_args->status = SOBEL_FAILURE;
-        
-        return NULL;
-    }
-
-    uint32_t n_write = 0;  								// Total number of bytes written to the output file
-    uint32_t transfer = thread_args->transfer_size;  	// Size of each DMA transfer
-    uint32_t total = thread_args->total_size;  			// Total size of data to be transferred
+    uint32_t n_recv;  									// Number of bytes of the tile received from the core
+    uint32_t transfer;  								// Size of each DMA transfer
+    uint32_t offset;  									// Offset of the tile in the processed tile stream
+    int tile;  											// Tile being received
+    uint64_t t0, t1;  									// Chunk timestamps
 
     Channel *channel = thread_args->channel;
 
-    while (n_write < total) {
+    while ( (tile = tile_fifo_pop(thread_args->queue, thread_args->inflight)) >= 0 ) {
 
-	    // Adjust the transfer size if remaining data is less than the transfer size.
-        if (transfer > (total - n_write)) {
-            transfer = total - n_write;
-        }
+        offset = (uint32_t)tile * TILE_OUT_SIZE;
 
-        channel->buf_ptr[buf_id].length = transfer;  // Set the length of the data to be transferred.
+        for (n_recv = 0; n_recv < TILE_OUT_SIZE; n_recv += transfer) {
 
-        // Start the DMA transfer from PL to PS.
-        if (ioctl(channel->fd, XFER, &buf_id) < 0) {
-            
-            #ifdef IS_VERBOSE
-                printf("[ERROR] PL to PS DMA transfer failed \n");
-                printf("[STATUS] Exiting with failure! \n");
-            #endif 
+            // Transfers never cross a tile boundary (the core asserts tlast at the end of every tile).
+            transfer = MIN(thread_args->transfer_size, TILE_OUT_SIZE - n_recv);
 
-            thread_args->status = SOBEL_FAILURE;
-            close(fo);
-            
-            return NULL;
-        }
+            channel->buf_ptr[buf_id].length = transfer;  // Set the length of the data to be transferred.
 
-        // Write the received data to the output file.
-        uint32_t n = write(fo, channel->buf_ptr[buf_id].buffer, transfer);
-        if (n <= 0) {
+            // Start the DMA transfer from PL to PS.
+            t0 = trace_now();
+            int ret = AXI_DMA_Transfer(channel, buf_id);
+            t1 = trace_now();
 
-            #ifdef IS_VERBOSE
-                printf("[WARN] Return vale from output file: %d", n);
-                printf("[STATUS] Terminating the thread. \n");
-            #endif
+            trace_record(thread_args->trace, ret < 0 || channel->buf_ptr[buf_id].status != PROXY_NO_ERROR ? TRACE_ERROR : TRACE_XFER, t0, t1, tile);
 
-            break;
-        }
+            if (ret < 0) {
+                
+                #ifdef IS_VERBOSE
+                    printf("[ERROR] PL to PS DMA transfer failed \n");
+                    printf("[STATUS] Exiting with failure! \n");
+                #endif 
 
-        if (channel->buf_ptr[buf_id].status != PROXY_NO_ERROR) {
-            
-            #ifdef IS_VERBOSE
-                printf("[ERROR] PL to PS DMA transfer encountered a proxy error \n");
-                printf("[STATUS] Exiting with failure! \n");
-            #endif
+                thread_args->status = SOBEL_FAILURE;
+                tile_queue_halt(thread_args->queue);
+                
+                return NULL;
+            }
 
-            thread_args->status = SOBEL_FAILURE;
-            close(fo); 
-            
-            return NULL;
-        }
+            if (channel->buf_ptr[buf_id].status != PROXY_NO_ERROR) {
+                
+                #ifdef IS_VERBOSE
+                    printf("[ERROR] PL to PS DMA transfer encountered a proxy error \n");
+                    printf("[STATUS] Exiting with failure! \n");
+                #endif
+
+                thread_args->status = SOBEL_FAILURE;
+                tile_queue_halt(thread_args->queue);
+                
+                return NULL;
+            }
 
-        n_write += n;  // Update the total number of bytes written 
+            // Place the valid part of the received data into the output image.
+            tiler_scatter(thread_args->tiler, thread_args->image, offset + n_recv, (const uint8_t *)channel->buf_ptr[buf_id].buffer, transfer);
 
+            trace_record(thread_args->trace, TRACE_SCATTER, t1, trace_now(), tile);
+        }
     }
 
     #ifdef IS_VERBOSE
         printf("[STATUS] PL to PS Thread terminated!\n");
     #endif 
 
-    close(fo);
-
-    thread_args->status = SOBEL_SUCCESS; 
-
     return NULL;
 	
 } /* end of pl2ps() */
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "tiler.h"
+#include "sobel_cpu.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+/*
+ * Function to split the rows [y0, y1) of an Nx x Ny image into tiles of the size the IP core
+ * is synthesised for. Tiles are laid out in raster order with a stride of TILE_STEP_X x TILE_STEP_Y,
+ * so that the valid outputs of neighbouring tiles abut and each tile carries a 1-pixel halo of
+ * its neighbours' data. Halo rows outside the band are read from the image, so bands computed
+ * by different engines stitch seamlessly. Tiles hanging over the right or bottom image edge are
+ * padded by replicating the last column/row. The outer ring of the image (and any column the
+ * last tile cannot reach) is left to tiler_fix_borders().
+ * @param tiler : The tiler data structure.
+ * @param Nx    : Image columns.
+ * @param Ny    : Image rows.
+ * @param y0    : First row of the band.
+ * @param y1    : One past the last row of the band.
+ */
+void tiler_init(sobel_tiler_t *tiler, int Nx, int Ny, int y0, int y1) {
+
+    tiler->Nx = Nx;
+    tiler->Ny = Ny;
+    tiler->y0 = y0;
+    tiler->y1 = y1;
+
+    // Interior rows of the band (the first and last image rows are left to the CPU)
+    tiler->first_y = MAX(y0, 1);
+    tiler->last_y  = MIN(y1, Ny - 1) - 1;
+
+    // Bands without an interior are handled entirely in software
+    if (Nx < 3 || tiler->last_y < tiler->first_y) {
+        tiler->tiles_x = 0;
+        tiler->tiles_y = 0;
+        tiler->first_y = y0;
+        tiler->last_y  = y0 - 1;
+        tiler->last_x  = 0;
+        return;
+    }
+
+    tiler->tiles_y = (tiler->last_y - tiler->first_y + TILE_STEP_Y) / TILE_STEP_Y;
+
+    // Interior columns 1 .. Nx-2; the last one is left to the CPU rather than spending
+    // a whole extra tile column on it when it is the only one left over
+    tiler->tiles_x = MAX(1, (Nx - 3 + TILE_STEP_X - 1) / TILE_STEP_X);
+    tiler->last_x  = MIN(Nx - 2, tiler->tiles_x * TILE_STEP_X);
+
+} /* end of tiler_init() */
+
+/*
+ * Function to get the size of the tiled input stream.
+ * @param tiler : The tiler data structure.
+ * @return      : The number of bytes to stream to the IP core.
+ */
+uint32_t tiler_input_size(const sobel_tiler_t *tiler) {
+    return (uint32_t)tiler->tiles_x * tiler->tiles_y * TILE_IN_SIZE;
+} /* end of tiler_input_size() */
+
+/*
+ * Function to get the size of the tiled output stream.
+ * @param tiler : The tiler data structure.
+ * @return      : The number of bytes the IP core returns.
+ */
+uint32_t tiler_output_size(const sobel_tiler_t *tiler) {
+    return (uint32_t)tiler->tiles_x * tiler->tiles_y * TILE_OUT_SIZE;
+} /* end of tiler_output_size() */
+
+/*
+ * Function to copy a range of the tiled input stream into a DMA buffer. The stream is
+ * the concatenation of all tiles in raster order, each one stored row by row.
+ * @param tiler  : The tiler data structure.
+ * @param image  : The source image (Nx * Ny bytes).
+ * @param offset : Offset of the range in the input stream.
+ * @param dst    : The destination buffer.
+ * @param length : The number of bytes to copy.
+ */
+void tiler_gather(const sobel_tiler_t *tiler, const uint8_t *image, uint32_t offset, uint8_t *dst, uint32_t length) {
+
+    while (length > 0) {
+
+        uint32_t tile   = offset / TILE_IN_SIZE;
+        uint32_t within = offset % TILE_IN_SIZE;
+
+        int row = within / SOBEL_IP_CORE_COLS;
+        int col = within % SOBEL_IP_CORE_COLS;
+
+        int y = tiler->first_y - 1 + (tile / tiler->tiles_x) * TILE_STEP_Y + row;
+        int x = (tile % tiler->tiles_x) * TILE_STEP_X + col;
+
+        uint32_t run = MIN(length, (uint32_t)(SOBEL_IP_CORE_COLS - col));
+
+        // Replicate the last row/column where the tile hangs over the image edge
+        const uint8_t *src = image + (size_t)MIN(y, tiler->Ny - 1) * tiler->Nx;
+        uint32_t real = x < tiler->Nx ? MIN(run, (uint32_t)(tiler->Nx - x)) : 0;
+
+        memcpy(dst, src + x, real);
+        memset(dst + real, src[tiler->Nx - 1], run - real);
+
+        dst    += run;
+        offset += run;
+        length -= run;
+    }
+
+} /* end of tiler_gather() */
+
+/*
+ * Function to place a range of the tiled output stream into the output image. Only the
+ * valid part of every tile is kept; halo outputs and padding are dropped.
+ * @param tiler  : The tiler data structure.
+ * @param image  : The output image (Nx * Ny bytes).
+ * @param offset : Offset of the range in the output stream.
+ * @param src    : The received DMA buffer.
+ * @param length : The number of bytes to place.
+ */
+void tiler_scatter(const sobel_tiler_t *tiler, uint8_t *image, uint32_t offset, const uint8_t *src, uint32_t length) {
+
+    while (length > 0) {
+
+        uint32_t tile   = offset / TILE_OUT_SIZE;
+        uint32_t within = offset % TILE_OUT_SIZE;
+
+        int i = within / TILE_OUT_COLS;
+        int j = within % TILE_OUT_COLS;
+
+        int y  = tiler->first_y + (tile / tiler->tiles_x) * TILE_STEP_Y + i;
+        int tx = (tile % tiler->tiles_x) * TILE_STEP_X;
+
+        uint32_t run = MIN(length, (uint32_t)(TILE_OUT_COLS - j));
+
+        if (y <= tiler->last_y) {
+
+            // Valid tile columns are 1 .. TILE_STEP_X, clipped to the columns owned by the accelerator
+            int j0 = MAX(j, 1);
+            int j1 = MIN(j + (int)run, MIN(TILE_STEP_X + 1, tiler->last_x - tx + 1));
+
+            if (j1 > j0) {
+                memcpy(image + (size_t)y * tiler->Nx + tx + j0, src + (j0 - j), j1 - j0);
+            }
+        }
+
+        src    += run;
+        offset += run;
+        length -= run;
+    }
+
+} /* end of tiler_scatter() */
+
+/*
+ * Function to compute in software the output pixels of the band the accelerator does not
+ * produce: the first and last image rows, the left column and any column right of the last tile.
+ * @param tiler : The tiler data structure.
+ * @param in    : The input image (Nx * Ny bytes).
+ * @param out   : The output image (Nx * Ny bytes).
+ */
+void tiler_fix_borders(const sobel_tiler_t *tiler, const uint8_t *in, uint8_t *out) {
+
+    int Nx = tiler->Nx;
+    int Ny = tiler->Ny;
+
+    // Band rows above and below the tiled rows
+    sobel_cpu_manhattan(in, out, Nx, Ny, 0, tiler->y0, Nx, tiler->first_y);
+    sobel_cpu_manhattan(in, out, Nx, Ny, 0, tiler->last_y + 1, Nx, tiler->y1);
+
+    // Left column and every column right of the last tile column
+    sobel_cpu_manhattan(in, out, Nx, Ny, 0, tiler->first_y, 1, tiler->last_y + 1);
+    sobel_cpu_manhattan(in, out, Nx, Ny, tiler->last_x + 1, tiler->first_y, Nx, tiler->last_y + 1);
+
+} /* end of tiler_fix_borders() */
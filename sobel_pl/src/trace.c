@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "trace.h"
+
+static const char *trace_kind_name[TRACE_KINDS] = { "gather", "xfer", "scatter", "error", "load", "store" };
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/*
+ * Function to read the monotonic clock.
+ * @return : The current time in ns.
+ */
+uint64_t trace_now(void) {
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+
+} /* end of trace_now() */
+
+/*
+ * Function to initialise an empty trace buffer. Its events are allocated and pre-faulted
+ * here, so that recording them later costs no allocation or page fault.
+ * @param buffer : The trace buffer.
+ * @param name   : The name of the thread that owns the buffer.
+ * @param events : The number of events the thread records over the run (capped at TRACE_MAX_EVENTS).
+ */
+void trace_init(trace_buffer_t *buffer, const char *name, uint64_t events) {
+
+    memset(buffer, 0, sizeof(*buffer));
+    snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+
+    uint32_t capacity = events < TRACE_MAX_EVENTS ? (uint32_t)events : TRACE_MAX_EVENTS;
+
+    if (capacity && (buffer->events = (trace_event_t *)malloc(capacity * sizeof(trace_event_t)))) {
+        memset(buffer->events, 0, capacity * sizeof(trace_event_t));
+        buffer->capacity = capacity;
+    }
+
+} /* end of trace_init() */
+
+/*
+ * Function to release the events of a trace buffer.
+ * @param buffer : The trace buffer.
+ */
+void trace_free(trace_buffer_t *buffer) {
+
+    free(buffer->events);
+
+    buffer->events = NULL;
+    buffer->count = 0;
+    buffer->capacity = 0;
+
+} /* end of trace_free() */
+
+/*
+ * Function to append an event to a trace buffer. Must only be called by the owning thread.
+ * @param buffer : The trace buffer.
+ * @param kind   : The event kind (TRACE_GATHER ... TRACE_STORE).
+ * @param start  : Start time in ns (from trace_now()).
+ * @param end    : End time in ns (from trace_now()).
+ * @param tile   : The tile the event belongs to, or -1.
+ */
+void trace_record(trace_buffer_t *buffer, int kind, uint64_t start, uint64_t end, int tile) {
+
+    if (buffer->count == buffer->capacity) {
+        buffer->dropped++;
+        return;
+    }
+
+    trace_event_t *event = &buffer->events[buffer->count++];
+
+    event->start = start;
+    event->duration = (uint32_t)(end - start > 0xffffffffull ? 0xffffffffull : end - start);
+    event->kind = (uint16_t)kind;
+    event->tile = tile;
+
+} /* end of trace_record() */
+
+/*
+ * Function to print the latency distribution (count, p50, p99, max and total) of every
+ * event kind recorded by every thread.
+ * @param buffers : The trace buffers.
+ * @param n       : Number of trace buffers.
+ */
+void trace_report(trace_buffer_t **buffers, int n) {
+
+    uint32_t max_count = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (buffers[i]->count > max_count) {
+            max_count = buffers[i]->count;
+        }
+    }
+
+    uint32_t *samples = (uint32_t *)malloc((max_count ? max_count : 1) * sizeof(uint32_t));
+
+    if (!samples) {
+        printf("[ERROR] Failed to allocate memory for the latency report \n");
+        return;
+    }
+
+    printf("Latency (us)          kind          count       p50       p99       max     total(ms) \n");
+
+    for (int i = 0; i < n; i++) {
+
+        trace_buffer_t *buffer = buffers[i];
+
+        for (int kind = 0; kind < TRACE_KINDS; kind++) {
+
+            uint32_t count = 0;
+            uint64_t total = 0;
+
+            for (uint32_t e = 0; e < buffer->count; e++) {
+                if (buffer->events[e].kind == kind) {
+                    samples[count++] = buffer->events[e].duration;
+                    total += buffer->events[e].duration;
+                }
+            }
+
+            if (count == 0) {
+                continue;
+            }
+
+            qsort(samples, count, sizeof(uint32_t), compare_u32);
+
+            printf("  %-20s%-8s %10u %9.1f %9.1f %9.1f %12.2f \n", buffer->name, trace_kind_name[kind], count,
+                   samples[(count - 1) / 2] / 1e3, samples[(uint32_t)((count - 1) * 0.99)] / 1e3,
+                   samples[count - 1] / 1e3, total / 1e6);
+        }
+
+        if (buffer->dropped) {
+            printf("  %-20s%u events not recorded (buffer full) \n", buffer->name, buffer->dropped);
+        }
+    }
+
+    free(samples);
+
+} /* end of trace_report() */
+
+/*
+ * Function to write all events as a Chrome trace-event JSON timeline (chrome://tracing, Perfetto).
+ * Every trace buffer becomes one row of the timeline.
+ * @param path    : Output file path.
+ * @param buffers : The trace buffers.
+ * @param n       : Number of trace buffers.
+ * @return        : 0 on success, 1 on failure.
+ */
+int trace_write_chrome(const char *path, trace_buffer_t **buffers, int n) {
+
+    FILE *fp = fopen(path, "w");
+
+    if (!fp) {
+        return 1;
+    }
+
+    // Timestamps are relative to the earliest event
+    uint64_t origin = UINT64_MAX;
+
+    for (int i = 0; i < n; i++) {
+        if (buffers[i]->count && buffers[i]->events[0].start < origin) {
+            origin = buffers[i]->events[0].start;
+        }
+    }
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"sobel-pl\"}}");
+
+    for (int i = 0; i < n; i++) {
+
+        trace_buffer_t *buffer = buffers[i];
+
+        fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", i, buffer->name);
+        fprintf(fp, ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"sort_index\":%d}}", i, i);
+
+        for (uint32_t e = 0; e < buffer->count; e++) {
+
+            trace_event_t *event = &buffer->events[e];
+
+            fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"dma\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"tile\":%d}}",
+                    trace_kind_name[event->kind], i, (event->start - origin) / 1e3, event->duration / 1e3, event->tile);
+        }
+    }
+
+    fprintf(fp, "\n]}\n");
+
+    return fclose(fp) != 0;
+
+} /* end of trace_write_chrome() */
@@ -0,0 +1,795 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "sobel.h"
+#include "sobel_ops.h"
+#include "sobel_hw.h"
+#include "sobel_edges.h"
+#include "sobel_hog.h"
+
+// Bit-exactness checks run by `make check`: every kernel is compared with a plain scalar model
+// written straight from its definition, on random frames of awkward sizes (single rows and
+// columns, odd widths around the vector lengths) and on saturating patterns.
+
+typedef struct {
+    const char *name;
+    long cases;
+    long failed;
+} check_t;
+
+// --- Test frames ---
+
+static uint32_t check_seed = 12345;
+
+static uint32_t check_rand(void) {
+    check_seed = check_seed * 1664525u + 1013904223u;
+    return check_seed >> 8;
+}
+
+// Random pixels, with flat blocks and 0/255 stripes mixed in so saturation and uniform areas occur
+static void fill_frame(uint8_t *data, int rows, int cols, size_t stride, int pattern) {
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            uint8_t v;
+            switch (pattern % 3) {
+                case 0:  v = (uint8_t)check_rand(); break;
+                case 1:  v = ((r / 4 + c / 4) & 1) ? 255 : 0; break;
+                default: v = (r / 8 + c / 8) % 3 ? (uint8_t)(r / 8 * 40 + c / 8) : (uint8_t)check_rand(); break;
+            }
+            data[(size_t)r * stride + c] = v;
+        }
+    }
+}
+
+static void check_result(check_t *check, int ok, const char *what, int rows, int cols, int variant) {
+    check->cases++;
+    if (!ok) {
+        if (check->failed++ < 10) {
+            printf("[FAIL] %s: %s on %d x %d (variant %d)\n", check->name, what, rows, cols, variant);
+        }
+    }
+}
+
+static int check_report(const check_t *check) {
+    printf("[%s] %s: %ld cases, %ld mismatching\n", check->failed ? "FAIL" : " OK ", check->name,
+           check->cases, check->failed);
+    return check->failed != 0;
+}
+
+// --- IP core model ---
+
+// Output (i, j) straight from the stream: pixel p = (i+1)*cols + j and its neighbours p +/- 1 and
+// p +/- cols, where index -1 is the cleared window buffer. Inputs go through the scaler shift
+// first, the Manhattan sum saturates at 255.
+static uint8_t hw_pixel(const uint8_t *input, int cols, int shift, int i, int j) {
+    long p = (long)(i + 1) * cols + j;
+    int w[3][3];
+
+    for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+            long q = p + (long)dr * cols + dc;
+            w[dr + 1][dc + 1] = q < 0 ? 0 : input[q] >> shift;
+        }
+    }
+
+    int gx = (w[0][2] - w[0][0]) + 2 * (w[1][2] - w[1][0]) + (w[2][2] - w[2][0]);
+    int gy = (w[0][0] + 2 * w[0][1] + w[0][2]) - (w[2][0] + 2 * w[2][1] + w[2][2]);
+    int m = abs(gx) + abs(gy);
+    return (uint8_t)(m > 255 ? 255 : m);
+}
+
+static int check_hw(void) {
+    static const int sizes[][2] = {
+        { 3, 3 }, { 3, 4 }, { 4, 3 }, { 5, 17 }, { 17, 5 }, { 3, 130 }, { 64, 64 }, { 33, 67 }, { 9, 257 }
+    };
+    check_t check = { "sobel_hw", 0, 0 };
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int rows = sizes[s][0], cols = sizes[s][1];
+        int n = (rows - 2) * (cols - 2);
+        uint8_t *input = malloc((size_t)rows * cols);
+        uint8_t *expected = malloc(n);
+        uint8_t *output = malloc(n);
+
+        for (int pattern = 0; pattern < 3; pattern++) {
+            fill_frame(input, rows, cols, cols, pattern);
+
+            for (int shift = SOBEL_HW_SCALE_NONE; shift <= SOBEL_HW_SCALE_DIV4; shift++) {
+                for (int i = 0; i < rows - 2; i++) {
+                    for (int j = 0; j < cols - 2; j++) {
+                        expected[i * (cols - 2) + j] = hw_pixel(input, cols, shift, i, j);
+                    }
+                }
+
+                // One thread, several threads, and the frame assembled from uneven bands
+                for (int threads = 1; threads <= 3; threads += 2) {
+                    memset(output, 0xa5, n);
+                    int ok = sobel_hw_frame(input, output, rows, cols, shift, threads) == 0
+                             && memcmp(output, expected, n) == 0;
+                    check_result(&check, ok, "sobel_hw_frame", rows, cols, threads * 4 + shift);
+                }
+
+                memset(output, 0xa5, n);
+                int ok = 1;
+                for (int i0 = 0, step = 1; i0 < rows - 2; i0 += step, step++) {
+                    int i1 = i0 + step < rows - 2 ? i0 + step : rows - 2;
+                    ok &= sobel_hw_band(input, output, rows, cols, shift, i0, i1) == 0;
+                }
+                check_result(&check, ok && memcmp(output, expected, n) == 0, "sobel_hw_band", rows, cols, shift);
+            }
+        }
+
+        free(input);
+        free(expected);
+        free(output);
+    }
+
+    return check_report(&check);
+}
+
+// --- Gradient operators ---
+
+typedef struct {
+    int radius;
+    int gain_shift;
+    int smooth[5];
+    int diff[5];
+} ref_op_t;
+
+// The operator definitions of sobel_ops.h, applied as full 2-D kernels
+static const ref_op_t ref_ops[SOBEL_OP_COUNT] = {
+    [SOBEL_OP_SOBEL]   = { 1, 0, { 1, 2, 1 },       { -1, 0, 1 } },
+    [SOBEL_OP_SCHARR]  = { 1, 2, { 3, 10, 3 },      { -1, 0, 1 } },
+    [SOBEL_OP_PREWITT] = { 1, 0, { 1, 1, 1 },       { -1, 0, 1 } },
+    [SOBEL_OP_SOBEL5]  = { 2, 3, { 1, 4, 6, 4, 1 }, { -1, -2, 0, 2, 1 } },
+};
+
+// References work on packed int frames so 8-bit and 16-bit input share them
+static int ref_at(const int *img, int rows, int cols, int r, int c) {
+    r = r < 0 ? 0 : (r >= rows ? rows - 1 : r);
+    c = c < 0 ? 0 : (c >= cols ? cols - 1 : c);
+    return img[(size_t)r * cols + c];
+}
+
+static void ref_gradients(sobel_op_t op, const int *img, int rows, int cols, int *gx, int *gy) {
+    const ref_op_t *k = &ref_ops[op];
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            int sx = 0, sy = 0;
+            for (int i = 0; i <= 2 * k->radius; i++) {
+                for (int j = 0; j <= 2 * k->radius; j++) {
+                    int p = ref_at(img, rows, cols, r + i - k->radius, c + j - k->radius);
+                    sx += k->smooth[i] * k->diff[j] * p;
+                    sy += k->diff[i] * k->smooth[j] * p;
+                }
+            }
+            gx[(size_t)r * cols + c] = sx;
+            gy[(size_t)r * cols + c] = sy;
+        }
+    }
+}
+
+static int ref_magnitude(int gx, int gy, int shift, int max, sobel_norm_t norm) {
+    int m;
+    if (norm == SOBEL_NORM_EUCLIDEAN) {
+        m = (int)(sqrt((double)gx * gx + (double)gy * gy) + 0.5) >> shift;
+    } else {
+        m = (abs(gx) + abs(gy)) >> shift;
+    }
+    return m > max ? max : m;
+}
+
+// Binomial 2-D blur, rounded once
+static void ref_blur(sobel_blur_t blur, const int *img, int rows, int cols, int *out) {
+    static const int taps3[] = { 1, 2, 1 }, taps5[] = { 1, 4, 6, 4, 1 };
+    const int *taps = blur == SOBEL_BLUR_3X3 ? taps3 : taps5;
+    int radius = blur == SOBEL_BLUR_3X3 ? 1 : 2;
+    int shift = blur == SOBEL_BLUR_3X3 ? 4 : 8;
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            int a = 1 << (shift - 1);
+            for (int i = 0; i <= 2 * radius; i++) {
+                for (int j = 0; j <= 2 * radius; j++) {
+                    a += taps[i] * taps[j] * ref_at(img, rows, cols, r + i - radius, c + j - radius);
+                }
+            }
+            out[(size_t)r * cols + c] = a >> shift;
+        }
+    }
+}
+
+// BT.601 luma of an RGB or BGR frame
+static void ref_luma(const uint8_t *frame, size_t stride, int rows, int cols, sobel_pixfmt_t format, int *img) {
+    int ri = format == SOBEL_PIX_RGB24 ? 0 : 2, bi = 2 - ri;
+
+    for (size_t i = 0; i < (size_t)rows * cols; i++) {
+        const uint8_t *px = frame + i / cols * stride + i % cols * 3;
+        img[i] = (77 * px[ri] + 150 * px[1] + 29 * px[bi] + 128) >> 8;
+    }
+}
+
+static int same_u8(const uint8_t *data, size_t stride, const int *expected, int rows, int cols) {
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            if (data[(size_t)r * stride + c] != expected[(size_t)r * cols + c]) return 0;
+        }
+    }
+    return 1;
+}
+
+static int same_s16(const int16_t *data, size_t stride, const int *expected, int rows, int cols) {
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            if (data[(size_t)r * stride + c] != expected[(size_t)r * cols + c]) return 0;
+        }
+    }
+    return 1;
+}
+
+static int same_u16(const uint16_t *data, size_t stride, const int *expected, int rows, int cols) {
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            if (data[(size_t)r * stride + c] != expected[(size_t)r * cols + c]) return 0;
+        }
+    }
+    return 1;
+}
+
+static const int check_sizes[][2] = {
+    { 1, 1 }, { 1, 9 }, { 9, 1 }, { 2, 2 }, { 3, 3 }, { 5, 5 }, { 4, 33 }, { 17, 5 }, { 31, 70 }, { 64, 129 }
+};
+
+#define CHECK_SIZES ((int)(sizeof(check_sizes) / sizeof(check_sizes[0])))
+#define CHECK_PAD   3       // extra elements per row, so strides differ from the width
+
+// 8-bit input through every entry point: plain, blurred, in place, YUV, and sobel.c for Sobel
+static void check_gray(check_t *check, int rows, int cols, int pattern) {
+    size_t stride = (size_t)cols + CHECK_PAD;
+    size_t n = (size_t)rows * cols;
+    uint8_t *frame = calloc((size_t)rows * 3 / 2 + 1, stride);
+    uint8_t *out = malloc(rows * stride);
+    int16_t *gx = malloc(rows * stride * sizeof(int16_t));
+    int16_t *gy = malloc(rows * stride * sizeof(int16_t));
+    int *img = malloc(n * sizeof(int)), *src = malloc(n * sizeof(int));
+    int *rgx = malloc(n * sizeof(int)), *rgy = malloc(n * sizeof(int)), *mag = malloc(n * sizeof(int));
+
+    fill_frame(frame, rows, cols, stride, pattern);
+    for (size_t i = 0; i < n; i++) {
+        img[i] = frame[i / cols * stride + i % cols];
+    }
+
+    // The chroma planes of I420 and NV12 must not be read
+    memset(frame + rows * stride, 0x5a, (size_t)(rows + 1) / 2 * stride);
+
+    for (sobel_op_t op = 0; op < SOBEL_OP_COUNT; op++) {
+        ref_gradients(op, img, rows, cols, rgx, rgy);
+        int ok = sobel_op_gradients(op, frame, rows, cols, stride, gx, gy, stride) == 0;
+        check_result(check, ok && same_s16(gx, stride, rgx, rows, cols) && same_s16(gy, stride, rgy, rows, cols),
+                     sobel_op_name(op), rows, cols, 0);
+        if (op == SOBEL_OP_SOBEL) {
+            sobel_gradients(frame, rows, cols, stride, gx, gy, stride);
+            check_result(check, same_s16(gx, stride, rgx, rows, cols) && same_s16(gy, stride, rgy, rows, cols),
+                         "sobel_gradients", rows, cols, 0);
+        }
+
+        for (int blur = 0; blur <= 5; blur += blur ? 2 : 3) {
+            if (blur) {
+                ref_blur(blur, img, rows, cols, src);
+                ref_gradients(op, src, rows, cols, rgx, rgy);
+            }
+
+            for (sobel_norm_t norm = SOBEL_NORM_MANHATTAN; norm <= SOBEL_NORM_EUCLIDEAN; norm++) {
+                int variant = blur * 2 + norm;
+                for (size_t i = 0; i < n; i++) {
+                    mag[i] = ref_magnitude(rgx[i], rgy[i], ref_ops[op].gain_shift, 255, norm);
+                }
+
+                ok = sobel_op_blur_magnitude(op, blur, frame, rows, cols, stride, out, stride, norm) == 0;
+                check_result(check, ok && same_u8(out, stride, mag, rows, cols), sobel_op_name(op), rows, cols, variant);
+
+                for (sobel_pixfmt_t format = SOBEL_PIX_I420; format <= SOBEL_PIX_NV12; format++) {
+                    sobel_frame_t yuv = { frame, rows, cols, stride, format };
+                    ok = sobel_op_frame_magnitude(op, blur, &yuv, out, stride, norm) == 0;
+                    check_result(check, ok && same_u8(out, stride, mag, rows, cols), "YUV", rows, cols, variant);
+                }
+
+                for (int r = 0; r < rows; r++) {
+                    memcpy(out + r * stride, frame + r * stride, cols);
+                }
+                ok = sobel_op_magnitude_inplace(op, blur, out, rows, cols, stride, norm) == 0;
+                check_result(check, ok && same_u8(out, stride, mag, rows, cols), "in place", rows, cols, variant);
+
+                if (op == SOBEL_OP_SOBEL && !blur) {
+                    sobel_magnitude(frame, rows, cols, stride, out, stride, norm);
+                    check_result(check, same_u8(out, stride, mag, rows, cols), "sobel_magnitude", rows, cols, norm);
+                    for (int tile = 0; tile <= 5; tile += 5) {
+                        sobel_magnitude_skip_flat(frame, rows, cols, stride, out, stride, norm, tile, NULL);
+                        check_result(check, same_u8(out, stride, mag, rows, cols), "sobel_magnitude_skip_flat",
+                                     rows, cols, norm);
+                    }
+                }
+            }
+        }
+    }
+
+    free(frame);
+    free(out);
+    free(gx);
+    free(gy);
+    free(img);
+    free(src);
+    free(rgx);
+    free(rgy);
+    free(mag);
+}
+
+// RGB and BGR input against BT.601 luma computed up front
+static void check_colour(check_t *check, int rows, int cols) {
+    size_t stride = (size_t)cols * 3 + CHECK_PAD;
+    size_t n = (size_t)rows * cols;
+    uint8_t *frame = malloc(rows * stride);
+    uint8_t *out = malloc(n);
+    int *img = malloc(n * sizeof(int)), *src = malloc(n * sizeof(int));
+    int *rgx = malloc(n * sizeof(int)), *rgy = malloc(n * sizeof(int)), *mag = malloc(n * sizeof(int));
+
+    fill_frame(frame, rows, cols * 3, stride, 0);
+
+    for (sobel_pixfmt_t format = SOBEL_PIX_RGB24; format <= SOBEL_PIX_BGR24; format++) {
+        ref_luma(frame, stride, rows, cols, format, img);
+
+        for (sobel_op_t op = 0; op < SOBEL_OP_COUNT; op++) {
+            for (int blur = 0; blur <= 3; blur += 3) {
+                if (blur) ref_blur(blur, img, rows, cols, src);
+                ref_gradients(op, blur ? src : img, rows, cols, rgx, rgy);
+                for (size_t i = 0; i < n; i++) {
+                    mag[i] = ref_magnitude(rgx[i], rgy[i], ref_ops[op].gain_shift, 255, SOBEL_NORM_MANHATTAN);
+                }
+
+                sobel_frame_t colour = { frame, rows, cols, stride, format };
+                int ok = sobel_op_frame_magnitude(op, blur, &colour, out, cols, SOBEL_NORM_MANHATTAN) == 0;
+                check_result(check, ok && same_u8(out, cols, mag, rows, cols), "RGB/BGR", rows, cols, format * 8 + blur);
+            }
+        }
+    }
+
+    free(frame);
+    free(out);
+    free(img);
+    free(src);
+    free(rgx);
+    free(rgy);
+    free(mag);
+}
+
+// uint16 input at several bit depths, scaled to 8 bits and kept wide
+static void check_wide(check_t *check, int rows, int cols) {
+    static const int depths[] = { 8, 10, 12, 16 };
+    size_t stride = (size_t)cols + CHECK_PAD;
+    size_t n = (size_t)rows * cols;
+    uint16_t *frame = malloc(rows * stride * sizeof(uint16_t));
+    uint8_t *out = malloc(n);
+    uint16_t *out16 = malloc(n * sizeof(uint16_t));
+    int *img = malloc(n * sizeof(int));
+    int *rgx = malloc(n * sizeof(int)), *rgy = malloc(n * sizeof(int)), *mag = malloc(n * sizeof(int));
+
+    for (int d = 0; d < 4; d++) {
+        int bits = depths[d];
+        for (size_t i = 0; i < n; i++) {
+            uint16_t v = (uint16_t)(check_rand() & ((1u << bits) - 1));
+            v = (i / cols / 4 + i % cols / 4) % 5 == 0 ? (uint16_t)((1u << bits) - 1) : v;
+            frame[i / cols * stride + i % cols] = v;
+            img[i] = v;
+        }
+
+        for (sobel_op_t op = 0; op < SOBEL_OP_COUNT; op++) {
+            ref_gradients(op, img, rows, cols, rgx, rgy);
+
+            for (sobel_norm_t norm = SOBEL_NORM_MANHATTAN; norm <= SOBEL_NORM_EUCLIDEAN; norm++) {
+                for (int scale = 0; scale <= 2; scale++) {
+                    for (size_t i = 0; i < n; i++) {
+                        mag[i] = ref_magnitude(rgx[i], rgy[i], ref_ops[op].gain_shift + bits - 8 + scale, 255, norm);
+                    }
+                    int ok = sobel_op_magnitude16(op, frame, rows, cols, stride, bits, scale, out, cols, norm) == 0;
+                    check_result(check, ok && same_u8(out, cols, mag, rows, cols), "16-bit", rows, cols,
+                                 bits * 8 + scale * 2 + norm);
+                }
+
+                for (size_t i = 0; i < n; i++) {
+                    mag[i] = ref_magnitude(rgx[i], rgy[i], ref_ops[op].gain_shift, 65535, norm);
+                }
+                int ok = sobel_op_magnitude16_wide(op, frame, rows, cols, stride, out16, cols, norm) == 0;
+                check_result(check, ok && same_u16(out16, cols, mag, rows, cols), "16-bit wide", rows, cols,
+                             bits * 8 + norm);
+            }
+        }
+    }
+
+    free(frame);
+    free(out);
+    free(out16);
+    free(img);
+    free(rgx);
+    free(rgy);
+    free(mag);
+}
+
+// Density grid: per-cell sums of the saturated magnitude and counts of pixels at the threshold
+static void check_density(check_t *check, int rows, int cols, int pattern) {
+    static const int cells[] = { 1, 3, 16 }, thresholds[] = { 0, 40, 255 };
+    size_t stride = (size_t)cols + CHECK_PAD;
+    size_t n = (size_t)rows * cols;
+    int grid_rows, grid_cols;
+    sobel_density_dims(rows, cols, 1, &grid_rows, &grid_cols);
+    uint8_t *frame = malloc(rows * stride);
+    uint8_t *out = malloc(n);
+    uint32_t *sum = malloc(n * sizeof(uint32_t)), *count = malloc(n * sizeof(uint32_t));
+    uint32_t *rsum = malloc(n * sizeof(uint32_t)), *rcount = malloc(n * sizeof(uint32_t));
+    int *img = malloc(n * sizeof(int)), *src = malloc(n * sizeof(int));
+    int *rgx = malloc(n * sizeof(int)), *rgy = malloc(n * sizeof(int)), *mag = malloc(n * sizeof(int));
+
+    fill_frame(frame, rows, cols, stride, pattern);
+    for (size_t i = 0; i < n; i++) {
+        img[i] = frame[i / cols * stride + i % cols];
+    }
+
+    for (sobel_op_t op = 0; op < SOBEL_OP_COUNT; op++) {
+        for (int blur = 0; blur <= 3; blur += 3) {
+            if (blur) ref_blur(blur, img, rows, cols, src);
+            ref_gradients(op, blur ? src : img, rows, cols, rgx, rgy);
+
+            for (sobel_norm_t norm = SOBEL_NORM_MANHATTAN; norm <= SOBEL_NORM_EUCLIDEAN; norm++) {
+                for (size_t i = 0; i < n; i++) {
+                    mag[i] = ref_magnitude(rgx[i], rgy[i], ref_ops[op].gain_shift, 255, norm);
+                }
+
+                for (int k = 0; k < 3; k++) {
+                    int cell = cells[k], threshold = thresholds[k];
+                    sobel_density_dims(rows, cols, cell, &grid_rows, &grid_cols);
+                    size_t cells_n = (size_t)grid_rows * grid_cols;
+                    memset(rsum, 0, cells_n * sizeof(uint32_t));
+                    memset(rcount, 0, cells_n * sizeof(uint32_t));
+                    for (size_t i = 0; i < n; i++) {
+                        size_t g = (size_t)(i / cols / cell) * grid_cols + i % cols / cell;
+                        rsum[g] += mag[i];
+                        rcount[g] += mag[i] >= threshold;
+                    }
+
+                    // With the magnitude written, and with the grid only and no counts
+                    int variant = (blur * 2 + norm) * 4 + k;
+                    sobel_frame_t gray = { frame, rows, cols, stride, SOBEL_PIX_GRAY8 };
+                    sobel_density_t density = { cell, threshold, sum, count };
+                    int ok = sobel_op_density(op, blur, &gray, out, cols, norm, &density) == 0;
+                    ok = ok && same_u8(out, cols, mag, rows, cols);
+                    ok = ok && memcmp(sum, rsum, cells_n * sizeof(uint32_t)) == 0
+                         && memcmp(count, rcount, cells_n * sizeof(uint32_t)) == 0;
+                    check_result(check, ok, "density", rows, cols, variant);
+
+                    density.count = NULL;
+                    memset(sum, 0xa5, cells_n * sizeof(uint32_t));
+                    ok = sobel_op_density(op, blur, &gray, NULL, 0, norm, &density) == 0
+                         && memcmp(sum, rsum, cells_n * sizeof(uint32_t)) == 0;
+                    check_result(check, ok, "density grid only", rows, cols, variant);
+                }
+            }
+        }
+    }
+
+    free(frame);
+    free(out);
+    free(sum);
+    free(count);
+    free(rsum);
+    free(rcount);
+    free(img);
+    free(src);
+    free(rgx);
+    free(rgy);
+    free(mag);
+}
+
+// 2x2 average, rounded; an odd last row or column is paired with itself
+static void ref_downsample(const int *img, int rows, int cols, int *half) {
+    int half_cols = (cols + 1) / 2;
+
+    for (int r = 0; r < (rows + 1) / 2; r++) {
+        for (int c = 0; c < half_cols; c++) {
+            int a = ref_at(img, rows, cols, 2 * r, 2 * c) + ref_at(img, rows, cols, 2 * r, 2 * c + 1)
+                    + ref_at(img, rows, cols, 2 * r + 1, 2 * c) + ref_at(img, rows, cols, 2 * r + 1, 2 * c + 1);
+            half[(size_t)r * half_cols + c] = (a + 2) >> 2;
+        }
+    }
+}
+
+// Pyramid levels against downsampling the whole image first, then the magnitude of each level
+static void check_pyramid(check_t *check, int rows, int cols, int pattern) {
+    static const int levels = 4;
+    size_t stride = (size_t)cols * 3 + CHECK_PAD;
+    size_t n = (size_t)rows * cols;
+    sobel_pyramid_t pyramid;
+    sobel_pyramid_layout(rows, cols, levels, &pyramid);
+    uint8_t *frame = malloc(rows * stride);
+    uint8_t *arena = malloc(pyramid.bytes);
+    int *img = malloc(n * sizeof(int)), *level = malloc(n * sizeof(int));
+    int *rgx = malloc(n * sizeof(int)), *rgy = malloc(n * sizeof(int)), *mag = malloc(n * sizeof(int));
+
+    for (sobel_pixfmt_t format = SOBEL_PIX_GRAY8; format <= SOBEL_PIX_RGB24; format++) {
+        sobel_frame_t input = { frame, rows, cols, stride, format };
+        if (format == SOBEL_PIX_GRAY8) {
+            fill_frame(frame, rows, cols, stride, pattern);
+            for (size_t i = 0; i < n; i++) {
+                img[i] = frame[i / cols * stride + i % cols];
+            }
+        } else {
+            fill_frame(frame, rows, cols * 3, stride, pattern);
+            ref_luma(frame, stride, rows, cols, format, img);
+        }
+
+        for (sobel_op_t op = 0; op < SOBEL_OP_COUNT; op++) {
+            for (sobel_norm_t norm = SOBEL_NORM_MANHATTAN; norm <= SOBEL_NORM_EUCLIDEAN; norm++) {
+                memset(arena, 0xa5, pyramid.bytes);
+                int ok = sobel_op_pyramid(op, &input, norm, &pyramid, arena) == 0;
+
+                memcpy(level, img, n * sizeof(int));
+                for (int l = 0; l < levels; l++) {
+                    int lr = pyramid.rows[l], lc = pyramid.cols[l];
+                    if (l) ref_downsample(mag, pyramid.rows[l - 1], pyramid.cols[l - 1], level);
+                    ref_gradients(op, level, lr, lc, rgx, rgy);
+
+                    // The next level is built from this one's pixels, kept aside in mag
+                    memcpy(mag, level, (size_t)lr * lc * sizeof(int));
+                    for (size_t i = 0; i < (size_t)lr * lc; i++) {
+                        level[i] = ref_magnitude(rgx[i], rgy[i], ref_ops[op].gain_shift, 255, norm);
+                    }
+                    ok = ok && same_u8(arena + pyramid.offset[l], lc, level, lr, lc);
+                }
+                check_result(check, ok, format == SOBEL_PIX_GRAY8 ? "pyramid" : "pyramid RGB", rows, cols,
+                             op * 2 + norm);
+            }
+        }
+    }
+
+    free(frame);
+    free(arena);
+    free(img);
+    free(level);
+    free(rgx);
+    free(rgy);
+    free(mag);
+}
+
+static int check_ops(void) {
+    check_t check = { "sobel_ops", 0, 0 };
+
+    for (int s = 0; s < CHECK_SIZES; s++) {
+        for (int pattern = 0; pattern < 3; pattern++) {
+            check_gray(&check, check_sizes[s][0], check_sizes[s][1], pattern);
+        }
+        check_colour(&check, check_sizes[s][0], check_sizes[s][1]);
+        check_wide(&check, check_sizes[s][0], check_sizes[s][1]);
+        for (int pattern = 0; pattern < 3; pattern++) {
+            check_density(&check, check_sizes[s][0], check_sizes[s][1], pattern);
+            check_pyramid(&check, check_sizes[s][0], check_sizes[s][1], pattern);
+        }
+    }
+
+    return check_report(&check);
+}
+
+// --- Thin edges ---
+
+static int ref_mag_at(const int *mag, int rows, int cols, int r, int c) {
+    return r < 0 || r >= rows || c < 0 || c >= cols ? 0 : mag[(size_t)r * cols + c];
+}
+
+// Full-plane Canny: unsaturated |Gx| + |Gy|, non-maximum suppression across the quantised
+// direction (zero outside the frame), then a flood fill from every strong pixel through the
+// weak ones, eight-connected
+static void ref_edges(const int *gx, const int *gy, int rows, int cols, int shift, int low, int high,
+                      int *mag, int *stack, int *edges) {
+    size_t n = (size_t)rows * cols, top = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        mag[i] = (abs(gx[i]) + abs(gy[i])) >> shift;
+    }
+
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            size_t i = (size_t)r * cols + c;
+            int m = mag[i], ax = abs(gx[i]), ay = abs(gy[i]);
+            int dr, dc;
+
+            if (ay * 128 <= ax * 53) {
+                dr = 0, dc = 1;
+            } else if (ay * 128 >= ax * 309) {
+                dr = 1, dc = 0;
+            } else if ((gx[i] < 0) == (gy[i] < 0)) {
+                dr = 1, dc = 1;
+            } else {
+                dr = 1, dc = -1;
+            }
+
+            int a = ref_mag_at(mag, rows, cols, r - dr, c - dc), b = ref_mag_at(mag, rows, cols, r + dr, c + dc);
+            if (m == 0 || m < low || m <= a || m < b) {
+                edges[i] = SOBEL_NO_EDGE;
+            } else if (m >= high) {
+                edges[i] = SOBEL_EDGE;
+                stack[top++] = (int)i;
+            } else {
+                edges[i] = 1;
+            }
+        }
+    }
+
+    while (top) {
+        int i = stack[--top], r = i / cols, c = i % cols;
+        for (int y = r - 1; y <= r + 1; y++) {
+            for (int x = c - 1; x <= c + 1; x++) {
+                if (y >= 0 && y < rows && x >= 0 && x < cols && edges[(size_t)y * cols + x] == 1) {
+                    edges[(size_t)y * cols + x] = SOBEL_EDGE;
+                    stack[top++] = y * cols + x;
+                }
+            }
+        }
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        edges[i] = edges[i] == SOBEL_EDGE ? SOBEL_EDGE : SOBEL_NO_EDGE;
+    }
+}
+
+static void check_edges_frame(check_t *check, int rows, int cols, int pattern) {
+    static const int thresholds[][2] = { { 0, 0 }, { 20, 60 }, { 60, 200 }, { 150, 150 }, { 400, 1000 } };
+    size_t stride = (size_t)cols + CHECK_PAD;
+    size_t n = (size_t)rows * cols;
+    uint8_t *frame = malloc(rows * stride);
+    uint8_t *out = malloc(rows * stride);
+    int *img = malloc(n * sizeof(int)), *src = malloc(n * sizeof(int));
+    int *rgx = malloc(n * sizeof(int)), *rgy = malloc(n * sizeof(int)), *mag = malloc(n * sizeof(int));
+    int *stack = malloc(n * sizeof(int)), *edges = malloc(n * sizeof(int));
+
+    fill_frame(frame, rows, cols, stride, pattern);
+    for (size_t i = 0; i < n; i++) {
+        img[i] = frame[i / cols * stride + i % cols];
+    }
+
+    for (sobel_op_t op = 0; op < SOBEL_OP_COUNT; op++) {
+        for (int blur = 0; blur <= 5; blur += blur ? 2 : 3) {
+            if (blur) ref_blur(blur, img, rows, cols, src);
+            ref_gradients(op, blur ? src : img, rows, cols, rgx, rgy);
+
+            for (int t = 0; t < (int)(sizeof(thresholds) / sizeof(thresholds[0])); t++) {
+                int low = thresholds[t][0], high = thresholds[t][1];
+                ref_edges(rgx, rgy, rows, cols, ref_ops[op].gain_shift, low, high, mag, stack, edges);
+                int ok = sobel_edges(op, blur, frame, rows, cols, stride, out, stride, low, high) == 0;
+                check_result(check, ok && same_u8(out, stride, edges, rows, cols), sobel_op_name(op), rows, cols,
+                             blur * 8 + t);
+            }
+        }
+    }
+
+    free(frame);
+    free(out);
+    free(img);
+    free(src);
+    free(rgx);
+    free(rgy);
+    free(mag);
+    free(stack);
+    free(edges);
+}
+
+static int check_edges(void) {
+    check_t check = { "sobel_edges", 0, 0 };
+
+    for (int s = 0; s < CHECK_SIZES; s++) {
+        for (int pattern = 0; pattern < 3; pattern++) {
+            check_edges_frame(&check, check_sizes[s][0], check_sizes[s][1], pattern);
+        }
+    }
+
+    return check_report(&check);
+}
+
+// --- Orientation histograms ---
+
+// Histograms against atan2. A pixel within 1e-3 rad of a bin boundary may fall on either side
+// of it with the Q14 boundary vectors, so its vote is only required to reach one of the two bins:
+// each bin must hold at least its certain votes and at most those plus its possible ones.
+static void check_hog_frame(check_t *check, int rows, int cols, int pattern) {
+    static const int cells[] = { 1, 3, 8 }, bin_counts[] = { 1, 4, 9, 36 };
+    size_t stride = (size_t)cols + CHECK_PAD;
+    size_t n = (size_t)rows * cols;
+    uint8_t *frame = malloc(rows * stride);
+    uint32_t *hist = malloc(n * SOBEL_HOG_MAX_BINS * sizeof(uint32_t));
+    long *certain = malloc(n * SOBEL_HOG_MAX_BINS * sizeof(long));
+    long *possible = malloc(n * SOBEL_HOG_MAX_BINS * sizeof(long));
+    int *img = malloc(n * sizeof(int)), *src = malloc(n * sizeof(int));
+    int *rgx = malloc(n * sizeof(int)), *rgy = malloc(n * sizeof(int));
+
+    fill_frame(frame, rows, cols, stride, pattern);
+    for (size_t i = 0; i < n; i++) {
+        img[i] = frame[i / cols * stride + i % cols];
+    }
+    sobel_frame_t gray = { frame, rows, cols, stride, SOBEL_PIX_GRAY8 };
+
+    for (sobel_op_t op = 0; op < SOBEL_OP_COUNT; op++) {
+        for (int blur = 0; blur <= 3; blur += 3) {
+            if (blur) ref_blur(blur, img, rows, cols, src);
+            ref_gradients(op, blur ? src : img, rows, cols, rgx, rgy);
+
+            for (sobel_norm_t norm = SOBEL_NORM_MANHATTAN; norm <= SOBEL_NORM_EUCLIDEAN; norm++) {
+                for (int k = 0; k < 3 * 4; k++) {
+                    int cell = cells[k / 4], bins = bin_counts[k % 4];
+                    int grid_rows, grid_cols;
+                    sobel_density_dims(rows, cols, cell, &grid_rows, &grid_cols);
+                    size_t size = (size_t)grid_rows * grid_cols * bins;
+                    long total = 0;
+                    memset(certain, 0, size * sizeof(long));
+                    memset(possible, 0, size * sizeof(long));
+
+                    for (size_t i = 0; i < n; i++) {
+                        int vote = ref_magnitude(rgx[i], rgy[i], ref_ops[op].gain_shift, 1 << 30, norm);
+                        size_t h = ((size_t)(i / cols / cell) * grid_cols + i % cols / cell) * bins;
+                        double angle = atan2(rgy[i], rgx[i]);
+                        angle = angle < 0 ? angle + M_PI : (angle >= M_PI ? angle - M_PI : angle);
+                        double t = angle * bins / M_PI;
+                        int nearest = (int)floor(t + 0.5);
+                        total += vote;
+
+                        if (angle > 0 && fabs(angle - nearest * M_PI / bins) < 1e-3) {
+                            possible[h + (nearest + bins - 1) % bins] += vote;
+                            possible[h + nearest % bins] += vote;
+                        } else {
+                            int b = (int)t;
+                            certain[h + (b < bins ? b : bins - 1)] += vote;
+                        }
+                    }
+
+                    memset(hist, 0xa5, size * sizeof(uint32_t));
+                    int ok = sobel_hog(op, blur, &gray, cell, bins, norm, hist) == 0;
+                    for (size_t i = 0; ok && i < size; i++) {
+                        ok = hist[i] >= certain[i] && hist[i] <= certain[i] + possible[i];
+                        total -= hist[i];
+                    }
+                    check_result(check, ok && total == 0, sobel_op_name(op), rows, cols, ((blur * 2 + norm) * 3 + k / 4) * 4 + k % 4);
+                }
+            }
+        }
+    }
+
+    free(frame);
+    free(hist);
+    free(certain);
+    free(possible);
+    free(img);
+    free(src);
+    free(rgx);
+    free(rgy);
+}
+
+static int check_hog(void) {
+    check_t check = { "sobel_hog", 0, 0 };
+
+    for (int s = 0; s < CHECK_SIZES; s++) {
+        for (int pattern = 0; pattern < 3; pattern++) {
+            check_hog_frame(&check, check_sizes[s][0], check_sizes[s][1], pattern);
+        }
+    }
+
+    return check_report(&check);
+}
+
+int main(void) {
+    int failed = 0;
+
+    failed |= check_hw();
+    failed |= check_ops();
+    failed |= check_edges();
+    failed |= check_hog();
+
+    return failed;
+}
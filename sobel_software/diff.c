@@ -0,0 +1,483 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "timer.h"
+#include "util.h"
+
+#define DIFF_DEFAULT_TILE   32
+
+typedef struct {
+    const uint8_t *data;     // rows * cols pixels
+    int rows;
+    int cols;
+    void *map;               // mmap of the file, NULL if the data was parsed from CSV
+    size_t map_size;
+    uint8_t *parsed;
+} diff_image_t;
+
+typedef struct {
+    uint64_t mismatches;
+    uint64_t sse;
+    int max_abs;
+    int tile_rows;
+    int tile_cols;
+    uint32_t *tiles;         // mismatches per tile, row major
+} diff_stats_t;
+
+typedef struct {
+    char a[4096];
+    char b[4096];
+    char name[256];
+} diff_pair_t;
+
+typedef struct {
+    diff_pair_t *pairs;
+    int count;
+    int next;
+    int differ;
+    int failed;
+    int rows;                // -y, 0 = from the file name
+    int cols;                // -x, 0 = from the file name
+    int tile;
+    int heatmap;
+    int bitmap;
+    int csv;                 // -f: 1 CSV, 0 raw, -1 decided from the content
+    const char *out_dir;
+    char **lines;            // one result line per pair, printed in order
+    pthread_mutex_t lock;
+} diff_batch_t;
+
+// --- Loading ---
+
+// A file holding only digits, whitespace and commas is taken as CSV; a raw frame stops at its
+// first other byte, which for image data is almost always among the first few
+static int looks_like_csv(const char *p, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        char ch = p[i];
+        if ((ch < '0' || ch > '9') && ch != ',' && ch != ' ' && ch != '\t' && ch != '\n' && ch != '\r') {
+            return 0;
+        }
+    }
+    return size != 0;
+}
+
+// Raw files are used in place; CSV files are parsed as whitespace or comma separated values
+// (the one-value-per-line board dumps). csv < 0 picks the format from the content.
+static int open_image(const char *path, int rows, int cols, int csv, diff_image_t *img) {
+    memset(img, 0, sizeof(*img));
+
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror(path);
+        if (fd >= 0) close(fd);
+        return 1;
+    }
+
+    size_t size = st.st_size;
+    void *map = size ? mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[ERROR] %s: cannot map %zu bytes\n", path, size);
+        return 1;
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    img->map = map;
+    img->map_size = size;
+
+    // Full frame or core output size (two rows and columns less)
+    size_t full = (size_t)rows * cols, core = (size_t)(rows - 2) * (cols - 2);
+    if (csv < 0) {
+        csv = looks_like_csv(map, size);
+    }
+    if (!csv) {
+        if (size != full && size != core) {
+            fprintf(stderr, "[ERROR] %s: %zu bytes, expected %zu or %zu (use -f csv for text)\n", path, size, full, core);
+            munmap(map, size);
+            img->map = NULL;
+            return 1;
+        }
+        img->data = map;
+        img->rows = size == full ? rows : rows - 2;
+        img->cols = size == full ? cols : cols - 2;
+        return 0;
+    }
+
+    uint8_t *values = malloc(full);
+    const char *p = map, *end = p + size;
+    size_t n = 0;
+
+    while (values && p < end && n <= full) {
+        while (p < end && (*p < '0' || *p > '9')) p++;
+        if (p == end) break;
+
+        int v = 0;
+        while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+        if (n < full) values[n] = v > 255 ? 255 : v;
+        n++;
+    }
+
+    if (!values || (n != full && n != core)) {
+        fprintf(stderr, "[ERROR] %s: %zu values, expected %zu or %zu\n", path, n, full, core);
+        free(values);
+        munmap(map, size);
+        img->map = NULL;
+        return 1;
+    }
+
+    img->parsed = values;
+    img->data = values;
+    img->rows = n == full ? rows : rows - 2;
+    img->cols = n == full ? cols : cols - 2;
+    return 0;
+}
+
+static void close_image(diff_image_t *img) {
+    if (img->map) munmap(img->map, img->map_size);
+    free(img->parsed);
+}
+
+// --- Comparison ---
+
+// One tile-wide run of a row; plain loops over uint8 that the compiler turns into
+// unsigned min/max/subtract and widening multiply-accumulate
+static void diff_run(const uint8_t *a, const uint8_t *b, uint8_t *mask, int n,
+                     uint32_t *mismatches, uint32_t *sse, uint8_t *max_abs) {
+    uint32_t count = 0, sum = 0;
+    uint8_t max = *max_abs;
+
+    for (int j = 0; j < n; j++) {
+        uint8_t hi = a[j] > b[j] ? a[j] : b[j];
+        uint8_t lo = a[j] > b[j] ? b[j] : a[j];
+        uint8_t d = hi - lo;
+
+        count += d != 0;
+        sum += (uint32_t)d * d;
+        max = d > max ? d : max;
+    }
+
+    if (mask) {
+        for (int j = 0; j < n; j++) {
+            mask[j] = a[j] != b[j] ? 255 : 0;
+        }
+    }
+
+    *mismatches += count;
+    *sse += sum;
+    *max_abs = max;
+}
+
+// A full frame is compared with a core output through the window the core sees:
+// core (i, j) against frame (i+1, j)
+static int diff_images(const diff_image_t *a, const diff_image_t *b, int tile, uint8_t **mask, diff_stats_t *st) {
+    const diff_image_t *core = a, *full = b;
+    if (a->rows > b->rows) {
+        core = b;
+        full = a;
+    }
+
+    int rows = core->rows, cols = core->cols;
+    int margin = full->rows - rows;
+    if ((margin != 0 && margin != 2) || full->cols != cols + margin) {
+        return 1;
+    }
+    int row_off = margin / 2;
+
+    memset(st, 0, sizeof(*st));
+    st->tile_rows = (rows + tile - 1) / tile;
+    st->tile_cols = (cols + tile - 1) / tile;
+    st->tiles = calloc((size_t)st->tile_rows * st->tile_cols, sizeof(uint32_t));
+    if (!st->tiles) return 1;
+
+    if (mask) {
+        *mask = malloc((size_t)rows * cols);
+        if (!*mask) return 1;
+    }
+
+    uint8_t max_abs = 0;
+
+    for (int i = 0; i < rows; i++) {
+        const uint8_t *ra = core->data + (size_t)i * cols;
+        const uint8_t *rb = full->data + (size_t)(i + row_off) * full->cols;
+        uint32_t *trow = st->tiles + (size_t)(i / tile) * st->tile_cols;
+
+        for (int j = 0; j < cols; j += tile) {
+            int n = cols - j < tile ? cols - j : tile;
+            uint32_t count = 0, sse = 0;
+
+            diff_run(ra + j, rb + j, mask ? *mask + (size_t)i * cols + j : NULL, n, &count, &sse, &max_abs);
+
+            trow[j / tile] += count;
+            st->mismatches += count;
+            st->sse += sse;
+        }
+    }
+
+    st->max_abs = max_abs;
+    return 0;
+}
+
+// --- Outputs ---
+
+static int write_heatmap(const char *path, const diff_stats_t *st) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    for (int i = 0; i < st->tile_rows; i++) {
+        for (int j = 0; j < st->tile_cols; j++) {
+            fprintf(file, j ? ",%u" : "%u", st->tiles[(size_t)i * st->tile_cols + j]);
+        }
+        fputc('\n', file);
+    }
+    return fclose(file) != 0;
+}
+
+static int write_bitmap(const char *path, const uint8_t *mask, int rows, int cols) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    fprintf(file, "P5\n%d %d\n255\n", cols, rows);
+    int result = fwrite(mask, 1, (size_t)rows * cols, file) != (size_t)rows * cols;
+    return (fclose(file) != 0) | result;
+}
+
+// --- Batch ---
+
+static int diff_pair(diff_batch_t *batch, int index) {
+    const diff_pair_t *pair = &batch->pairs[index];
+    int rows = batch->rows, cols = batch->cols;
+
+    if ((!rows || !cols) && parse_image_dims(pair->a, &rows, &cols) != 0 && parse_image_dims(pair->b, &rows, &cols) != 0) {
+        fprintf(stderr, "[ERROR] %s: no dimensions in the name, use -x and -y\n", pair->a);
+        return -1;
+    }
+
+    diff_image_t a, b;
+    if (open_image(pair->a, rows, cols, batch->csv, &a) != 0) return -1;
+    if (open_image(pair->b, rows, cols, batch->csv, &b) != 0) {
+        close_image(&a);
+        return -1;
+    }
+
+    diff_stats_t st = { 0 };
+    uint8_t *mask = NULL;
+    int result = diff_images(&a, &b, batch->tile, batch->bitmap ? &mask : NULL, &st);
+
+    if (result != 0) {
+        fprintf(stderr, "[ERROR] %s (%d x %d) and %s (%d x %d) cannot be compared\n",
+                pair->a, a.cols, a.rows, pair->b, b.cols, b.rows);
+    } else {
+        int out_rows = a.rows < b.rows ? a.rows : b.rows;
+        int out_cols = a.cols < b.cols ? a.cols : b.cols;
+        double pixels = (double)out_rows * out_cols;
+        double mse = st.sse / pixels;
+        double psnr = mse > 0 ? 10.0 * log10(255.0 * 255.0 / mse) : INFINITY;
+        char path[4400];
+
+        if (batch->heatmap) {
+            snprintf(path, sizeof(path), "%s/heatmap_%s.csv", batch->out_dir, pair->name);
+            result |= write_heatmap(path, &st);
+        }
+        if (batch->bitmap) {
+            snprintf(path, sizeof(path), "%s/diff_%s.pgm", batch->out_dir, pair->name);
+            result |= write_bitmap(path, mask, out_rows, out_cols);
+        }
+
+        char *line = malloc(512);
+        if (line) {
+            snprintf(line, 512, "%s,%d,%d,%.0f,%llu,%.6f,%d,%.4f,%.3f\n", pair->name, out_cols, out_rows, pixels,
+                     (unsigned long long)st.mismatches, st.mismatches / pixels, st.max_abs, mse, psnr);
+        }
+        batch->lines[index] = line;
+    }
+
+    free(mask);
+    free(st.tiles);
+    close_image(&a);
+    close_image(&b);
+
+    return result != 0 ? -1 : st.mismatches != 0;
+}
+
+static void *diff_worker(void *arg) {
+    diff_batch_t *batch = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&batch->lock);
+        int i = batch->next++;
+        pthread_mutex_unlock(&batch->lock);
+
+        if (i >= batch->count) {
+            return NULL;
+        }
+
+        int result = diff_pair(batch, i);
+
+        pthread_mutex_lock(&batch->lock);
+        batch->failed += result < 0;
+        batch->differ += result > 0;
+        pthread_mutex_unlock(&batch->lock);
+    }
+}
+
+static int is_dir(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp(((const diff_pair_t *)a)->name, ((const diff_pair_t *)b)->name);
+}
+
+// Two files, or two directories paired by file name
+static int collect_pairs(const char *a, const char *b, diff_batch_t *batch) {
+    if (!is_dir(a) || !is_dir(b)) {
+        batch->pairs = calloc(1, sizeof(diff_pair_t));
+        if (!batch->pairs) return 1;
+
+        const char *base = strrchr(b, '/');
+        snprintf(batch->pairs[0].a, sizeof(batch->pairs[0].a), "%s", a);
+        snprintf(batch->pairs[0].b, sizeof(batch->pairs[0].b), "%s", b);
+        snprintf(batch->pairs[0].name, sizeof(batch->pairs[0].name), "%s", base ? base + 1 : b);
+        batch->count = 1;
+        return 0;
+    }
+
+    DIR *dir = opendir(a);
+    if (!dir) {
+        perror(a);
+        return 1;
+    }
+
+    int capacity = 0;
+    struct dirent *entry;
+
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+
+        if (batch->count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            diff_pair_t *pairs = realloc(batch->pairs, capacity * sizeof(diff_pair_t));
+            if (!pairs) {
+                closedir(dir);
+                return 1;
+            }
+            batch->pairs = pairs;
+        }
+
+        diff_pair_t *pair = &batch->pairs[batch->count];
+        snprintf(pair->a, sizeof(pair->a), "%s/%s", a, entry->d_name);
+        snprintf(pair->b, sizeof(pair->b), "%s/%s", b, entry->d_name);
+        snprintf(pair->name, sizeof(pair->name), "%s", entry->d_name);
+
+        if (access(pair->b, R_OK) == 0 && !is_dir(pair->a)) {
+            batch->count++;
+        }
+    }
+    closedir(dir);
+
+    qsort(batch->pairs, batch->count, sizeof(diff_pair_t), compare_names);
+    return 0;
+}
+
+static void usage(const char *app) {
+    printf("Usage: %s [-x COLS -y ROWS] [-f raw|csv] [-t TILE] [-m] [-b] [-d OUTDIR] [-j THREADS] <A> <B>\n", app);
+    printf("Compares two outputs, or every file of directory A with the file of the same name in B.\n");
+    printf("Files are raw bytes or CSV values, either the full frame or the (ROWS-2) x (COLS-2) core output;\n");
+    printf("a file of only digits, commas and whitespace is read as CSV unless -f says otherwise;\n");
+    printf("a full frame is compared with a core output at the pixels the core computes.\n");
+    printf("  -x, -y   Frame size (default: parsed from <name>_<cols>_<rows>...)\n");
+    printf("  -f       Read both inputs as raw bytes or as CSV values (default: from the content)\n");
+    printf("  -t       Heatmap tile size in pixels (default %d)\n", DIFF_DEFAULT_TILE);
+    printf("  -m       Write heatmap_<name>.csv, mismatches per tile\n");
+    printf("  -b       Write diff_<name>.pgm, 255 where the pixels differ\n");
+    printf("  -d       Output directory for -m and -b (default .)\n");
+    printf("  -j       Worker threads (default: online CPUs)\n");
+    printf("Exit status: 0 identical, 1 differences, 2 errors\n");
+    printf("Example: %s ../data/outputs/output_hw_lena_512_512_csv.txt golden_lena_512_512_raw\n", app);
+}
+
+int main(int argc, char *argv[]) {
+    diff_batch_t batch = { .tile = DIFF_DEFAULT_TILE, .csv = -1, .out_dir = "." };
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int opt, bad = 0;
+
+    while ((opt = getopt(argc, argv, "x:y:f:t:mbd:j:h")) != -1) {
+        switch (opt) {
+            case 'x': batch.cols = atoi(optarg); break;
+            case 'y': batch.rows = atoi(optarg); break;
+            case 'f': batch.csv = !strcmp(optarg, "csv"); bad |= !batch.csv && strcmp(optarg, "raw"); break;
+            case 't': batch.tile = atoi(optarg); bad |= batch.tile < 1; break;
+            case 'm': batch.heatmap = 1; break;
+            case 'b': batch.bitmap = 1; break;
+            case 'd': batch.out_dir = optarg; break;
+            case 'j': threads = atoi(optarg); break;
+            default: bad = 1; break;
+        }
+    }
+
+    if (bad || argc - optind != 2 || (!batch.rows != !batch.cols)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (collect_pairs(argv[optind], argv[optind + 1], &batch) != 0 || batch.count == 0) {
+        fprintf(stderr, "[ERROR] Nothing to compare\n");
+        free(batch.pairs);
+        return 2;
+    }
+
+    batch.lines = calloc(batch.count, sizeof(char *));
+    if (!batch.lines) {
+        free(batch.pairs);
+        return 2;
+    }
+
+    if (threads < 1) threads = 1;
+    if (threads > batch.count) threads = batch.count;
+    pthread_mutex_init(&batch.lock, NULL);
+
+    double start_time = get_current_time();
+
+    pthread_t *tids = malloc(threads * sizeof(pthread_t));
+    int started = 0;
+    while (tids && started < threads && pthread_create(&tids[started], NULL, diff_worker, &batch) == 0) {
+        started++;
+    }
+    if (started == 0) {
+        diff_worker(&batch);
+    }
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    free(tids);
+
+    double elapsed = get_elapsed_time(start_time);
+
+    printf("name,width,height,pixels,mismatches,mismatch_ratio,max_abs_error,mse,psnr_db\n");
+    for (int i = 0; i < batch.count; i++) {
+        if (batch.lines[i]) fputs(batch.lines[i], stdout);
+        free(batch.lines[i]);
+    }
+    fprintf(stderr, "Compared %d pairs in %.6f seconds: %d identical, %d differ, %d failed\n",
+            batch.count, elapsed, batch.count - batch.differ - batch.failed, batch.differ, batch.failed);
+
+    pthread_mutex_destroy(&batch.lock);
+    free(batch.lines);
+    free(batch.pairs);
+    return batch.failed ? 2 : batch.differ ? 1 : 0;
+}
@@ -0,0 +1,515 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "sobel_hw.h"
+#include "sobel_io.h"
+#include "sobel_pool.h"
+#include "sobel_sched.h"
+#include "timer.h"
+#include "util.h"
+
+typedef enum {
+    GOLDEN_READING,
+    GOLDEN_COMPUTING,
+    GOLDEN_WRITING
+} golden_stage_t;
+
+// One file of an asynchronous batch, from its read to the completion of its write
+typedef struct golden_job {
+    int index;
+    int rows;
+    int cols;
+    golden_stage_t stage;
+    uint8_t *input;          // pool buffers
+    uint8_t *output;
+    size_t out_size;
+    char out_path[4096];
+    struct golden_job *next;
+} golden_job_t;
+
+typedef struct {
+    char **files;
+    int count;
+    int failed;
+    int rows;                // -y, 0 = from the file name
+    int cols;                // -x, 0 = from the file name
+    int shift;
+    int csv;
+    int frame_threads;
+    const char *out_dir;
+    pthread_mutex_t lock;
+    sobel_pool_t *pool;      // frame buffers of the blocking batch
+
+    // Asynchronous batch (-q)
+    sobel_io_t *io;
+    golden_job_t *loaded;    // frames waiting for a worker, oldest first
+    golden_job_t *loaded_tail;
+    int closed;
+    pthread_cond_t ready;
+} golden_batch_t;
+
+// --- File helpers ---
+
+static int read_file(const char *path, uint8_t *data, size_t size) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    int result = fread(data, 1, size, file) != size;
+    if (result) {
+        fprintf(stderr, "[ERROR] %s is shorter than %zu bytes\n", path, size);
+    }
+    fclose(file);
+    return result;
+}
+
+// CSV output uses the format of the board dumps: one value per line, stream order
+static int write_file(const char *path, const uint8_t *data, size_t size, int csv) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        perror(path);
+        return 1;
+    }
+
+    int result = 0;
+    if (csv) {
+        for (size_t i = 0; i < size && !result; i++) {
+            result = fprintf(file, "%d\n", data[i]) < 0;
+        }
+    } else {
+        result = fwrite(data, 1, size, file) != size;
+    }
+
+    result |= fclose(file) != 0;
+    if (result) {
+        fprintf(stderr, "[ERROR] Writing %s\n", path);
+    }
+    return result;
+}
+
+// One value per line into a buffer of 4 bytes per value
+static size_t format_csv(const uint8_t *data, size_t size, uint8_t *out) {
+    uint8_t *p = out;
+    for (size_t i = 0; i < size; i++) {
+        int v = data[i];
+        if (v >= 100) *p++ = (uint8_t)('0' + v / 100);
+        if (v >= 10) *p++ = (uint8_t)('0' + v / 10 % 10);
+        *p++ = (uint8_t)('0' + v % 10);
+        *p++ = '\n';
+    }
+    return (size_t)(p - out);
+}
+
+// --- Batch ---
+
+static int golden_dims(const golden_batch_t *batch, const char *path, int *rows, int *cols) {
+    *rows = batch->rows;
+    *cols = batch->cols;
+
+    if ((!*rows || !*cols) && parse_image_dims(path, rows, cols) != 0) {
+        fprintf(stderr, "[ERROR] %s: no dimensions in the name, use -x and -y\n", path);
+        return 1;
+    }
+    if (*rows < 3 || *cols < 3) {
+        fprintf(stderr, "[ERROR] %s: %d x %d is too small\n", path, *cols, *rows);
+        return 1;
+    }
+    return 0;
+}
+
+static void golden_out_path(const golden_batch_t *batch, const char *path, char *out_path, size_t size) {
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    snprintf(out_path, size, "%s/golden_%s%s", batch->out_dir, base, batch->csv ? "_csv.txt" : "");
+}
+
+// Largest input and output among the files, 1 if none has a usable size
+static void golden_max_sizes(const golden_batch_t *batch, size_t *in_size, size_t *out_size) {
+    *in_size = *out_size = 1;
+    for (int i = 0; i < batch->count; i++) {
+        int rows = batch->rows, cols = batch->cols;
+        if (((rows && cols) || parse_image_dims(batch->files[i], &rows, &cols) == 0) && rows >= 3 && cols >= 3) {
+            size_t in = (size_t)rows * cols, out = (size_t)(rows - 2) * (cols - 2);
+            if (in > *in_size) *in_size = in;
+            if (out > *out_size) *out_size = out;
+        }
+    }
+}
+
+// --- Tile scheduler ---
+// Every file is a task; loading it splits the frame into bands of output rows that become tasks of
+// their own, each reading one halo row above and below from the shared input. A large frame is
+// therefore computed by every idle core, and small files fill the gaps between its tiles.
+
+// Tiles of about this many output pixels: enough to spread a 8K frame over many cores, long
+// enough that taking one costs nothing next to computing it
+#define GOLDEN_TILE_PIXELS (1 << 16)
+
+typedef struct {
+    int index;
+    int rows;
+    int cols;
+    uint8_t *input;
+    uint8_t *output;
+    int remaining;           // tiles not computed yet, the last one writes the file
+} golden_frame_t;
+
+static void golden_finish(golden_batch_t *batch, golden_frame_t *frame, int result) {
+    if (!result) {
+        char out_path[4096];
+        golden_out_path(batch, batch->files[frame->index], out_path, sizeof(out_path));
+        result = write_file(out_path, frame->output, (size_t)(frame->rows - 2) * (frame->cols - 2), batch->csv);
+    }
+    if (result) {
+        pthread_mutex_lock(&batch->lock);
+        batch->failed++;
+        pthread_mutex_unlock(&batch->lock);
+    }
+
+    sobel_pool_free(batch->pool, frame->input);
+    sobel_pool_free(batch->pool, frame->output);
+    free(frame);
+}
+
+static void golden_tile(golden_batch_t *batch, golden_frame_t *frame, int i0, int i1) {
+    sobel_hw_band(frame->input, frame->output, frame->rows, frame->cols, batch->shift, i0, i1);
+    if (__atomic_sub_fetch(&frame->remaining, 1, __ATOMIC_ACQ_REL) == 0) {
+        golden_finish(batch, frame, 0);
+    }
+}
+
+static void golden_load(sobel_sched_t *sched, int worker, golden_batch_t *batch, int index) {
+    const char *path = batch->files[index];
+    golden_frame_t *frame = calloc(1, sizeof(*frame));
+
+    if (!frame || golden_dims(batch, path, &frame->rows, &frame->cols) != 0) {
+        free(frame);
+        pthread_mutex_lock(&batch->lock);
+        batch->failed++;
+        pthread_mutex_unlock(&batch->lock);
+        return;
+    }
+
+    size_t in_size = (size_t)frame->rows * frame->cols;
+    frame->index = index;
+    frame->input = sobel_pool_alloc(batch->pool, in_size);
+    frame->output = sobel_pool_alloc(batch->pool, (size_t)(frame->rows - 2) * (frame->cols - 2));
+    if (!frame->input || !frame->output || read_file(path, frame->input, in_size) != 0) {
+        golden_finish(batch, frame, 1);
+        return;
+    }
+
+    int out_rows = frame->rows - 2;
+    int band = GOLDEN_TILE_PIXELS / (frame->cols - 2);
+    if (band < 1) band = 1;
+    frame->remaining = (out_rows + band - 1) / band;
+
+    // Queued bottom up, so this worker pops the top band first and thieves take the far end
+    for (int i0 = (frame->remaining - 1) * band; i0 >= 0; i0 -= band) {
+        int i1 = i0 + band < out_rows ? i0 + band : out_rows;
+        sobel_task_t task = { frame, i0, i1 };
+        if (sobel_sched_push(sched, worker, &task) != 0) {
+            golden_tile(batch, frame, i0, i1);
+        }
+    }
+}
+
+static void golden_task(sobel_sched_t *sched, int worker, const sobel_task_t *task, void *ctx) {
+    golden_batch_t *batch = ctx;
+
+    if (task->data) {
+        golden_tile(batch, task->data, (int)task->begin, (int)task->end);
+    } else {
+        golden_load(sched, worker, batch, (int)task->begin);
+    }
+}
+
+static int golden_size_order(const void *a, const void *b) {
+    const sobel_task_t *x = a, *y = b;
+    return (x->end > y->end) - (x->end < y->end);
+}
+
+static void golden_blocking(golden_batch_t *batch, int workers) {
+    sobel_task_t *tasks = malloc(batch->count * sizeof(sobel_task_t));
+    if (!tasks) {
+        fprintf(stderr, "[ERROR] Task allocation failed\n");
+        batch->failed = batch->count;
+        return;
+    }
+
+    // Files are dealt smallest first, so every worker starts on its largest one and thieves take
+    // the small ones; end holds the size for the sort only
+    for (int i = 0; i < batch->count; i++) {
+        int rows = batch->rows, cols = batch->cols;
+        if (((!rows || !cols) && parse_image_dims(batch->files[i], &rows, &cols) != 0) || rows < 3 || cols < 3) {
+            rows = cols = 2;
+        }
+        tasks[i] = (sobel_task_t){ NULL, i, (long)rows * cols };
+    }
+    qsort(tasks, batch->count, sizeof(sobel_task_t), golden_size_order);
+
+    // Workers mostly hold one frame each: the arena fits the largest ones, input and output, and
+    // anything beyond comes from the heap
+    size_t arena = 0;
+    for (int i = batch->count - 1; i >= 0 && i >= batch->count - workers; i--) {
+        arena += 2 * sobel_pool_class_size((size_t)tasks[i].end);
+    }
+    batch->pool = sobel_pool_create(arena, SOBEL_POOL_HUGE_PAGES);
+    if (!batch->pool) {
+        fprintf(stderr, "[ERROR] Frame pool allocation failed\n");
+        free(tasks);
+        batch->failed = batch->count;
+        return;
+    }
+
+    sobel_sched_stats_t stats;
+    if (sobel_sched_run(workers, tasks, batch->count, golden_task, batch, &stats) != 0) {
+        fprintf(stderr, "[ERROR] Scheduler allocation failed\n");
+        batch->failed = batch->count;
+    } else if (stats.wall > 0) {
+        printf("Scheduler: %ld tasks, %ld stolen, %.0f%% utilisation of %d workers\n", stats.tasks, stats.steals,
+               100.0 * stats.busy / (stats.wall * workers), workers);
+    }
+
+    free(tasks);
+    sobel_pool_destroy(batch->pool);
+}
+
+// --- Asynchronous batch (-q) ---
+// The main thread owns the I/O engine: it keeps up to DEPTH reads in flight, hands loaded frames to
+// the workers and recycles the pool buffers of finished writes. Workers queue their writes
+// themselves so the next reads never wait behind a computation.
+
+static void *golden_async_worker(void *arg) {
+    golden_batch_t *batch = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&batch->lock);
+        while (!batch->loaded && !batch->closed) {
+            pthread_cond_wait(&batch->ready, &batch->lock);
+        }
+        golden_job_t *job = batch->loaded;
+        if (job) {
+            batch->loaded = job->next;
+            if (!batch->loaded) batch->loaded_tail = NULL;
+        }
+        pthread_mutex_unlock(&batch->lock);
+
+        if (!job) {
+            return NULL;
+        }
+
+        job->out_size = (size_t)(job->rows - 2) * (job->cols - 2);
+        int error = sobel_hw_frame(job->input, job->output, job->rows, job->cols, batch->shift, batch->frame_threads) ? EINVAL : 0;
+
+        // CSV text goes into the input buffer, which is sized for it
+        if (!error && batch->csv) {
+            uint8_t *text = job->input;
+            job->input = job->output;
+            job->output = text;
+            job->out_size = format_csv(job->input, job->out_size, job->output);
+        }
+
+        job->stage = GOLDEN_WRITING;
+        golden_out_path(batch, batch->files[job->index], job->out_path, sizeof(job->out_path));
+        if (!error && sobel_io_write(batch->io, job->out_path, job->output, job->out_size, job) != 0) {
+            error = errno ? errno : EIO;
+        }
+        if (error) {
+            while (sobel_io_post(batch->io, job, error) != 0) {
+                sched_yield();
+            }
+        }
+    }
+}
+
+static void golden_release(golden_batch_t *batch, golden_job_t *job) {
+    if (job->input) sobel_io_put_buffer(batch->io, job->input);
+    if (job->output) sobel_io_put_buffer(batch->io, job->output);
+    free(job);
+}
+
+static void golden_async(golden_batch_t *batch, int depth, int workers) {
+    // Every buffer holds a whole input frame, or the CSV text of an output
+    size_t in_size, out_size;
+    golden_max_sizes(batch, &in_size, &out_size);
+    size_t text_size = batch->csv ? 4 * out_size : 0;
+    size_t buffer_size = in_size > text_size ? in_size : text_size;
+
+    // Two buffers per frame: reads in flight, frames being computed and writes in flight share them
+    batch->io = sobel_io_open(2 * depth, buffer_size, 1);
+    if (!batch->io) {
+        fprintf(stderr, "[ERROR] I/O buffer allocation failed\n");
+        batch->failed = batch->count;
+        return;
+    }
+    pthread_cond_init(&batch->ready, NULL);
+
+    pthread_t *tids = malloc(workers * sizeof(pthread_t));
+    int started = 0;
+    while (tids && started < workers && pthread_create(&tids[started], NULL, golden_async_worker, batch) == 0) {
+        started++;
+    }
+
+    int next = 0, finished = 0, reading = 0;
+    while (started && finished < batch->count) {
+        // Keep the read queue full while buffers last
+        while (next < batch->count && reading < depth) {
+            const char *path = batch->files[next];
+            golden_job_t *job = calloc(1, sizeof(*job));
+            if (!job) break;
+
+            job->index = next;
+            if (golden_dims(batch, path, &job->rows, &job->cols) != 0) {
+                free(job);
+                batch->failed++;
+                finished++;
+                next++;
+                continue;
+            }
+
+            job->input = sobel_io_get_buffer(batch->io);
+            job->output = sobel_io_get_buffer(batch->io);
+            if (!job->input || !job->output) {
+                golden_release(batch, job);
+                break;
+            }
+
+            job->stage = GOLDEN_READING;
+            if (sobel_io_read(batch->io, path, job->input, (size_t)job->rows * job->cols, job) != 0) {
+                perror(path);
+                golden_release(batch, job);
+                batch->failed++;
+                finished++;
+                next++;
+                continue;
+            }
+            next++;
+            reading++;
+        }
+        if (finished == batch->count) {
+            break;
+        }
+
+        sobel_io_event_t event;
+        if (sobel_io_wait(batch->io, &event) != 0) {
+            fprintf(stderr, "[ERROR] I/O engine failed\n");
+            break;
+        }
+
+        golden_job_t *job = event.user;
+        if (job->stage == GOLDEN_READING) {
+            reading--;
+            if (event.error) {
+                const char *path = batch->files[job->index];
+                if (event.error == EIO) {
+                    fprintf(stderr, "[ERROR] %s is shorter than %zu bytes\n", path, (size_t)job->rows * job->cols);
+                } else {
+                    fprintf(stderr, "[ERROR] %s: %s\n", path, strerror(event.error));
+                }
+                golden_release(batch, job);
+                batch->failed++;
+                finished++;
+                continue;
+            }
+
+            job->stage = GOLDEN_COMPUTING;
+            pthread_mutex_lock(&batch->lock);
+            if (batch->loaded_tail) {
+                batch->loaded_tail->next = job;
+            } else {
+                batch->loaded = job;
+            }
+            batch->loaded_tail = job;
+            pthread_cond_signal(&batch->ready);
+            pthread_mutex_unlock(&batch->lock);
+        } else {
+            if (event.error) {
+                fprintf(stderr, "[ERROR] Writing %s: %s\n", job->out_path, strerror(event.error));
+                batch->failed++;
+            }
+            golden_release(batch, job);
+            finished++;
+        }
+    }
+    batch->failed += batch->count - finished;
+
+    pthread_mutex_lock(&batch->lock);
+    batch->closed = 1;
+    pthread_cond_broadcast(&batch->ready);
+    pthread_mutex_unlock(&batch->lock);
+    for (int t = 0; t < started; t++) {
+        pthread_join(tids[t], NULL);
+    }
+    free(tids);
+
+    printf("I/O: %s, depth %d\n", sobel_io_uring(batch->io) ? "io_uring" : "blocking fallback", depth);
+    sobel_io_close(batch->io);
+    pthread_cond_destroy(&batch->ready);
+}
+
+static void usage(const char *app) {
+    printf("Usage: %s [-x COLS -y ROWS] [-s 0|1|2] [-f raw|csv] [-j THREADS] [-q DEPTH] [-d OUTDIR] <input_raw_file>...\n", app);
+    printf("Writes the exact output stream of the Sobel IP core, (ROWS-2) x (COLS-2) pixels, for every input.\n");
+    printf("  -x, -y   Frame size (default: parsed from <name>_<cols>_<rows>_raw)\n");
+    printf("  -s       scaler.vhd shift: 0 as shipped, 1 or 2 for the divide-by-2/4 variants\n");
+    printf("  -f       raw bytes or one value per line (board CSV dump format) (default raw)\n");
+    printf("  -j       Worker threads (default: online CPUs)\n");
+    printf("  -q       Keep DEPTH file reads in flight with io_uring, or blocking I/O where unavailable\n");
+    printf("  -d       Output directory, files are named golden_<input> (default .)\n");
+    printf("Example: %s -f csv ../data/raw/*_raw\n", app);
+}
+
+int main(int argc, char *argv[]) {
+    golden_batch_t batch = { .shift = SOBEL_HW_SCALE_NONE, .out_dir = "." };
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int depth = 0;
+    int opt, bad = 0;
+
+    while ((opt = getopt(argc, argv, "x:y:s:f:j:q:d:h")) != -1) {
+        switch (opt) {
+            case 'x': batch.cols = atoi(optarg); break;
+            case 'y': batch.rows = atoi(optarg); break;
+            case 's': batch.shift = atoi(optarg); bad |= batch.shift < 0 || batch.shift > 2; break;
+            case 'f': batch.csv = !strcmp(optarg, "csv"); bad |= !batch.csv && strcmp(optarg, "raw"); break;
+            case 'j': threads = atoi(optarg); break;
+            case 'q': depth = atoi(optarg); bad |= depth < 1; break;
+            case 'd': batch.out_dir = optarg; break;
+            default: bad = 1; break;
+        }
+    }
+
+    if (bad || optind == argc || (!batch.rows != !batch.cols)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (threads < 1) threads = 1;
+
+    batch.files = &argv[optind];
+    batch.count = argc - optind;
+
+    pthread_mutex_init(&batch.lock, NULL);
+
+    double start_time = get_current_time();
+
+    if (depth) {
+        // Whole files per worker behind the I/O thread; a lone file is split over rows instead
+        int workers = threads < batch.count ? threads : batch.count;
+        batch.frame_threads = threads / workers;
+        golden_async(&batch, depth, workers);
+    } else {
+        golden_blocking(&batch, threads);
+    }
+
+    double elapsed = get_elapsed_time(start_time);
+    printf("Generated %d of %d golden outputs in %.6f seconds\n", batch.count - batch.failed, batch.count, elapsed);
+
+    pthread_mutex_destroy(&batch.lock);
+    return batch.failed ? 1 : 0;
+}
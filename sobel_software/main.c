@@ -2,6 +2,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include "sobel.h"
+#include "sobel_ops.h"
+#include "sobel_edges.h"
+#include "sobel_pool.h"
 #include "timer.h"
 #include "util.h"
 #include "sobel_constants.h"
@@ -9,7 +12,7 @@
 int main(int argc, char *argv[]) {
     // Check command line arguments
     if (argc < 3) {
-        printf("Usage: %s <input_raw_file> <output_raw_file>\n", argv[0]);
+        printf("Usage: %s <input_raw_file> <output_raw_file> [sobel|scharr|prewitt|sobel5] [blur 0|3|5] [low high]\n", argv[0]);
         printf("Example: %s ../data/raw/lena_512_512_raw output_sobel.raw\n", argv[0]);
         return 1;
     }
@@ -17,44 +20,113 @@ int main(int argc, char *argv[]) {
     const char *input_filename = argv[1];
     const char *output_filename = argv[2];
 
+    // Optional gradient operator; without it the reference 3x3 Sobel kernels are used
+    sobel_op_t op = argc > 3 ? sobel_op_from_name(argv[3]) : SOBEL_OP_SOBEL;
+    if (op == SOBEL_OP_COUNT) {
+        printf("[ERROR] Unknown operator: %s\n", argv[3]);
+        return 1;
+    }
+
+    // Optional Gaussian pre-smoothing, fused with the gradient pass
+    sobel_blur_t blur = argc > 4 ? (sobel_blur_t)atoi(argv[4]) : SOBEL_BLUR_NONE;
+    if (blur != SOBEL_BLUR_NONE && blur != SOBEL_BLUR_3X3 && blur != SOBEL_BLUR_5X5) {
+        printf("[ERROR] Blur must be 0, 3 or 5: %s\n", argv[4]);
+        return 1;
+    }
+
+    // Optional thin edge map with hysteresis thresholds
+    int edge_low = argc > 6 ? atoi(argv[5]) : 0;
+    int edge_high = argc > 6 ? atoi(argv[6]) : 0;
+    if (argc > 6 && (edge_low < 0 || edge_high < edge_low)) {
+        printf("[ERROR] Thresholds must satisfy 0 <= low <= high\n");
+        return 1;
+    }
+
+    // RGB24 input is recognised by its size; YUV 4:2:0 files start with the Y plane and load as grey
+    sobel_frame_t frame = { NULL, ROW, COLUMN, COLUMN, SOBEL_PIX_GRAY8 };
+    if (raw_file_size(input_filename) == (long)sobel_frame_bytes(SOBEL_PIX_RGB24, ROW, COLUMN)) {
+        frame.format = SOBEL_PIX_RGB24;
+        frame.stride = 3 * COLUMN;
+    }
+    int use_ops = argc > 3 || frame.format != SOBEL_PIX_GRAY8;
+
+    // The Euclidean pass is the last one to read a grey input unless edges follow, so with an
+    // operator it runs in place and its output frame is never allocated. The default run keeps
+    // both passes on the plain kernels so the speedup factor compares like with like
+    int in_place = use_ops && frame.format == SOBEL_PIX_GRAY8 && argc <= 6;
+
+    // Frame buffers come from one pre-faulted arena, on huge pages where the system allows it,
+    // sized for the input and the output frames actually allocated
+    double start_time = get_current_time();
+    size_t frame_bytes = sobel_frame_bytes(frame.format, ROW, COLUMN);
+    int outputs = in_place ? 1 : 2;
+    sobel_pool_t *pool = sobel_pool_create(sobel_pool_class_size(frame_bytes) + outputs * sobel_pool_class_size(ROW * COLUMN),
+                                           SOBEL_POOL_HUGE_PAGES);
+    if (!pool) {
+        printf("[ERROR] Memory allocation failed\n");
+        return 1;
+    }
+    double pool_time = get_elapsed_time(start_time);
+
     // Allocate memory for input and output images
-    uint8_t (*input_image)[COLUMN] = malloc(ROW * COLUMN * sizeof(uint8_t));
-    uint8_t (*output_manhattan)[COLUMN] = malloc(ROW * COLUMN * sizeof(uint8_t));
-    uint8_t (*output_euclidean)[COLUMN] = malloc(ROW * COLUMN * sizeof(uint8_t));
+    uint8_t (*input_image)[COLUMN] = sobel_pool_alloc(pool, frame_bytes);
+    uint8_t (*output_manhattan)[COLUMN] = sobel_pool_alloc(pool, ROW * COLUMN * sizeof(uint8_t));
+    uint8_t (*output_euclidean)[COLUMN] = in_place ? input_image : sobel_pool_alloc(pool, ROW * COLUMN * sizeof(uint8_t));
 
     if (!input_image || !output_manhattan || !output_euclidean) {
         printf("[ERROR] Memory allocation failed\n");
-        free(input_image);
-        free(output_manhattan);
-        free(output_euclidean);
+        sobel_pool_free(pool, input_image);
+        sobel_pool_free(pool, output_manhattan);
+        if (!in_place) sobel_pool_free(pool, output_euclidean);
+        sobel_pool_destroy(pool);
         return 1;
     }
 
     // Load input image
     printf("Loading image from: %s\n", input_filename);
-    double start_time = get_current_time();
-    if (load_raw_image(input_filename, input_image) != 0) {
+    start_time = get_current_time();
+    int load_result = frame.format == SOBEL_PIX_GRAY8 ? load_raw_image(input_filename, input_image)
+                      : load_raw_frame(input_filename, &input_image[0][0], sobel_frame_bytes(frame.format, ROW, COLUMN));
+    frame.data = input_image;
+    if (load_result != 0) {
         printf("[ERROR] Failed to load input image\n");
-        free(input_image);
-        free(output_manhattan);
-        free(output_euclidean);
+        sobel_pool_free(pool, input_image);
+        sobel_pool_free(pool, output_manhattan);
+        if (!in_place) sobel_pool_free(pool, output_euclidean);
+        sobel_pool_destroy(pool);
         return 1;
     }
     double load_time = get_elapsed_time(start_time);
     printf("Image loaded successfully in %.6f seconds\n", load_time);
-    printf("Image dimensions: %d x %d\n\n", ROW, COLUMN);
+    printf("Image dimensions: %d x %d%s\n", ROW, COLUMN, frame.format == SOBEL_PIX_RGB24 ? " (RGB24)" : "");
+    sobel_pool_stats_t pool_stats;
+    sobel_pool_stats(pool, &pool_stats);
+    static const char *const page_names[] = { "4 KB pages", "transparent huge pages", "hugetlb pages" };
+    printf("Frame pool: %.1f MB on %s, pre-faulted in %.6f seconds\n\n", pool_stats.arena / 1048576.0,
+           page_names[pool_stats.pages], pool_time);
 
     // Apply Sobel Manhattan distance
     printf("=== Sobel Manhattan Distance (|Gx| + |Gy|) ===\n");
     start_time = get_current_time();
-    sobel_manhattan(input_image, output_manhattan);
+    if (use_ops) {
+        printf("Operator: %s, blur: %d\n", sobel_op_name(op), (int)blur);
+        sobel_op_frame_magnitude(op, blur, &frame, &output_manhattan[0][0], COLUMN, SOBEL_NORM_MANHATTAN);
+    } else {
+        sobel_manhattan(input_image, output_manhattan);
+    }
     double manhattan_time = get_elapsed_time(start_time);
     printf("Processing time: %.6f seconds\n\n", manhattan_time);
 
     // Apply Sobel Euclidean distance
-    printf("=== Sobel Euclidean Distance (sqrt(Gx² + Gy²)) ===\n");
+    printf("=== Sobel Euclidean Distance (sqrt(Gx² + Gy²))%s ===\n", in_place ? ", in place" : "");
     start_time = get_current_time();
-    sobel_euclidean(input_image, output_euclidean);
+    if (in_place) {
+        sobel_op_magnitude_inplace(op, blur, &input_image[0][0], ROW, COLUMN, COLUMN, SOBEL_NORM_EUCLIDEAN);
+    } else if (use_ops) {
+        sobel_op_frame_magnitude(op, blur, &frame, &output_euclidean[0][0], COLUMN, SOBEL_NORM_EUCLIDEAN);
+    } else {
+        sobel_euclidean(input_image, output_euclidean);
+    }
     double euclidean_time = get_elapsed_time(start_time);
     printf("Processing time: %.6f seconds\n\n", euclidean_time);
 
@@ -63,9 +135,10 @@ int main(int argc, char *argv[]) {
     start_time = get_current_time();
     if (save_raw_image(output_filename, output_manhattan) != 0) {
         printf("[ERROR] Failed to save output image\n");
-        free(input_image);
-        free(output_manhattan);
-        free(output_euclidean);
+        sobel_pool_free(pool, input_image);
+        sobel_pool_free(pool, output_manhattan);
+        if (!in_place) sobel_pool_free(pool, output_euclidean);
+        sobel_pool_destroy(pool);
         return 1;
     }
     double save_time = get_elapsed_time(start_time);
@@ -82,19 +155,44 @@ int main(int argc, char *argv[]) {
         printf("Euclidean output saved successfully\n\n");
     }
 
+    // Thin edges (NMS + hysteresis) fused with the gradient pass
+    double edges_time = 0;
+    if (argc > 6) {
+        printf("=== Thin Edges (low %d, high %d) ===\n", edge_low, edge_high);
+        start_time = get_current_time();
+        if (sobel_edges_frame(op, blur, &frame, &output_manhattan[0][0], COLUMN, edge_low, edge_high) != 0) {
+            printf("[ERROR] Edge detection failed\n");
+        } else {
+            edges_time = get_elapsed_time(start_time);
+            printf("Processing time: %.6f seconds\n", edges_time);
+
+            char edges_filename[256];
+            snprintf(edges_filename, sizeof(edges_filename), "%s_edges.raw", output_filename);
+            printf("Saving edge map to: %s\n\n", edges_filename);
+            if (save_raw_image(edges_filename, output_manhattan) != 0) {
+                printf("[ERROR] Failed to save edge map\n");
+            }
+        }
+    }
+
     // Print summary
     printf("=== Performance Summary ===\n");
     printf("Load time:           %.6f seconds\n", load_time);
     printf("Manhattan time:      %.6f seconds\n", manhattan_time);
     printf("Euclidean time:      %.6f seconds\n", euclidean_time);
+    if (argc > 6) {
+        printf("Edges time:          %.6f seconds\n", edges_time);
+    }
     printf("Save time:           %.6f seconds\n", save_time);
     printf("Total time:          %.6f seconds\n", load_time + manhattan_time + euclidean_time + save_time);
-    printf("\nSpeedup factor (Manhattan vs Euclidean): %.2fx\n", euclidean_time / manhattan_time);
+    printf("\nSpeedup factor (Manhattan vs %sEuclidean): %.2fx\n", in_place ? "in-place " : "",
+           euclidean_time / manhattan_time);
 
     // Clean up
-    free(input_image);
-    free(output_manhattan);
-    free(output_euclidean);
+    sobel_pool_free(pool, input_image);
+    sobel_pool_free(pool, output_manhattan);
+    if (!in_place) sobel_pool_free(pool, output_euclidean);
+    sobel_pool_destroy(pool);
 
     printf("\nProcessing complete!\n");
     return 0;
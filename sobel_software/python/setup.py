@@ -0,0 +1,21 @@
+"""
+Build the sobel_native extension from the sobel_software sources.
+
+    cd sobel_software/python
+    python3 setup.py build_ext --inplace
+"""
+
+from setuptools import Extension, setup
+
+setup(
+    name='sobel_native',
+    version='1.0',
+    ext_modules=[
+        Extension(
+            'sobel_native',
+            sources=['sobel_native.c', '../sobel.c', '../sobel_ops.c', '../sobel_edges.c', '../sobel_hog.c', '../sobel_hw.c'],
+            extra_compile_args=['-std=gnu99', '-O3'],
+            libraries=['m', 'pthread'],
+        )
+    ],
+)
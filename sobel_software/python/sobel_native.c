@@ -0,0 +1,773 @@
+// Python bindings for the sobel_software kernels.
+//
+// Images are taken through the buffer protocol (NumPy arrays, memoryviews, bytearrays...) and are
+// never copied: any 2-D uint8 buffer with unit column stride is accepted, including row-strided
+// slices. With format='rgb24' or 'bgr24' the image is rows x cols x 3; with 'i420' or 'nv12' it
+// is the whole (rows * 3 / 2) x cols frame as OpenCV lays it out, and only the Y rows are read.
+// Results are written into an optional `out` buffer, or into a new bytearray returned as a 2-D
+// memoryview that numpy.asarray() wraps without copying. The GIL is released while computing.
+// Arguments are checked here before any kernel runs and raise TypeError or ValueError, so a
+// kernel that still fails has run out of memory.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include <stdint.h>
+#include "../sobel.h"
+#include "../sobel_ops.h"
+#include "../sobel_edges.h"
+#include "../sobel_hog.h"
+#include "../sobel_hw.h"
+
+typedef struct {
+    Py_buffer view;
+    int rows;
+    int cols;
+    size_t stride;           // in elements
+} image_arg_t;
+
+// --- Buffer helpers ---
+// Formats are struct codes: "B" uint8, "h" int16, "H" uint16, "I" uint32
+
+static Py_ssize_t format_item(const char *format) {
+    return format[0] == 'B' ? 1 : (format[0] == 'I' ? 4 : 2);
+}
+
+static const char *format_type(const char *format) {
+    switch (format[0]) {
+        case 'B': return "uint8";
+        case 'H': return "uint16";
+        case 'I': return "uint32";
+        default:  return "int16";
+    }
+}
+
+// Stride of a dimension in bytes; exporters such as ctypes leave strides NULL for C-contiguous data
+static Py_ssize_t buffer_stride(const Py_buffer *v, int dim) {
+    if (v->strides) {
+        return v->strides[dim];
+    }
+    Py_ssize_t stride = v->itemsize;
+    for (int d = v->ndim - 1; d > dim; d--) {
+        stride *= v->shape[d];
+    }
+    return stride;
+}
+
+static int get_image(PyObject *obj, const char *format, int writable, image_arg_t *img, const char *what) {
+    int flags = PyBUF_STRIDES | PyBUF_FORMAT | (writable ? PyBUF_WRITABLE : 0);
+
+    if (PyObject_GetBuffer(obj, &img->view, flags) != 0) {
+        return 1;
+    }
+
+    Py_buffer *v = &img->view;
+    Py_ssize_t item = format_item(format);
+    const char *f = v->format ? v->format : "B";
+    if (f[0] == '=' || f[0] == '<' || f[0] == '@') f++;
+
+    if (v->ndim != 2 || v->itemsize != item || strcmp(f, format) != 0) {
+        PyErr_Format(PyExc_TypeError, "%s must be a 2-D %s array", what, format_type(format));
+    } else if (buffer_stride(v, 1) != item || buffer_stride(v, 0) < v->shape[1] * item || buffer_stride(v, 0) % item) {
+        PyErr_Format(PyExc_ValueError, "%s rows must be contiguous with a positive row stride", what);
+    } else if (v->shape[0] < 1 || v->shape[1] < 1) {
+        PyErr_Format(PyExc_ValueError, "%s must not be empty", what);
+    } else if (v->shape[0] > INT32_MAX || v->shape[1] > INT32_MAX) {
+        PyErr_Format(PyExc_ValueError, "%s is too large", what);
+    } else {
+        img->rows = (int)v->shape[0];
+        img->cols = (int)v->shape[1];
+        img->stride = (size_t)(buffer_stride(v, 0) / item);
+        return 0;
+    }
+
+    PyBuffer_Release(v);
+    return 1;
+}
+
+// Whether two views share any byte, from the first byte of their first row to the last byte of
+// their last row (strides are positive once get_image or get_frame accepted the views)
+static int views_overlap(const Py_buffer *a, const Py_buffer *b) {
+    const char *a0 = a->buf, *b0 = b->buf;
+    const char *a1 = a0 + (a->shape[0] - 1) * buffer_stride(a, 0) + a->shape[1] * buffer_stride(a, 1);
+    const char *b1 = b0 + (b->shape[0] - 1) * buffer_stride(b, 0) + b->shape[1] * buffer_stride(b, 1);
+    return a0 < b1 && b0 < a1;
+}
+
+// Outputs that share memory with the input (or each other) would be read back half-written
+static int check_no_overlap(const image_arg_t *a, const image_arg_t *b, const char *what_a, const char *what_b) {
+    if (views_overlap(&a->view, &b->view)) {
+        PyErr_Format(PyExc_ValueError, "%s must not overlap %s", what_a, what_b);
+        return 1;
+    }
+    return 0;
+}
+
+// Use `out` if given, else allocate; either way `result` holds the object to return
+static int get_output(PyObject *out, const char *format, int rows, int cols, image_arg_t *img,
+                      PyObject **result, const char *what) {
+    if (out && out != Py_None) {
+        if (get_image(out, format, 1, img, what) != 0) {
+            return 1;
+        }
+        if (img->rows != rows || img->cols != cols) {
+            PyErr_Format(PyExc_ValueError, "%s must be %d x %d", what, rows, cols);
+            PyBuffer_Release(&img->view);
+            return 1;
+        }
+        Py_INCREF(out);
+        *result = out;
+        return 0;
+    }
+
+    Py_ssize_t item = format_item(format);
+    PyObject *bytes = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t)rows * cols * item);
+    if (!bytes) {
+        return 1;
+    }
+
+    PyObject *flat = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    if (!flat) {
+        return 1;
+    }
+
+    PyObject *shaped = PyObject_CallMethod(flat, "cast", "s(ii)", format, rows, cols);
+    Py_DECREF(flat);
+    if (!shaped) {
+        return 1;
+    }
+
+    if (get_image(shaped, format, 1, img, what) != 0) {
+        Py_DECREF(shaped);
+        return 1;
+    }
+    *result = shaped;
+    return 0;
+}
+
+// Input frame in any format, see the header comment for the expected shapes
+static int get_frame(PyObject *obj, const char *format_name, image_arg_t *img, sobel_frame_t *frame) {
+    sobel_pixfmt_t format = format_name ? sobel_pixfmt_from_name(format_name) : SOBEL_PIX_GRAY8;
+    if (format == SOBEL_PIX_COUNT) {
+        PyErr_Format(PyExc_ValueError, "unknown format '%s'", format_name);
+        return 1;
+    }
+
+    if (format != SOBEL_PIX_RGB24 && format != SOBEL_PIX_BGR24) {
+        if (get_image(obj, "B", 0, img, "image") != 0) {
+            return 1;
+        }
+        if (format != SOBEL_PIX_GRAY8) {
+            if (img->rows % 3 || img->cols % 2) {
+                PyErr_SetString(PyExc_ValueError, "YUV 4:2:0 image must be (rows * 3 / 2) x cols with even sizes");
+                PyBuffer_Release(&img->view);
+                return 1;
+            }
+            img->rows = img->rows / 3 * 2;
+        }
+        *frame = (sobel_frame_t){ img->view.buf, img->rows, img->cols, img->stride, format };
+        return 0;
+    }
+
+    if (PyObject_GetBuffer(obj, &img->view, PyBUF_STRIDES | PyBUF_FORMAT) != 0) {
+        return 1;
+    }
+
+    Py_buffer *v = &img->view;
+    const char *f = v->format ? v->format : "B";
+    if (f[0] == '=' || f[0] == '<' || f[0] == '@') f++;
+
+    if (v->ndim != 3 || v->itemsize != 1 || strcmp(f, "B") != 0 || v->shape[2] != 3) {
+        PyErr_SetString(PyExc_TypeError, "image must be a rows x cols x 3 uint8 array");
+    } else if (buffer_stride(v, 2) != 1 || buffer_stride(v, 1) != 3 || buffer_stride(v, 0) < v->shape[1] * 3) {
+        PyErr_SetString(PyExc_ValueError, "image pixels must be packed with a positive row stride");
+    } else if (v->shape[0] < 1 || v->shape[1] < 1) {
+        PyErr_SetString(PyExc_ValueError, "image must not be empty");
+    } else if (v->shape[0] > INT32_MAX || v->shape[1] > INT32_MAX) {
+        PyErr_SetString(PyExc_ValueError, "image is too large");
+    } else {
+        img->rows = (int)v->shape[0];
+        img->cols = (int)v->shape[1];
+        img->stride = (size_t)buffer_stride(v, 0);
+        *frame = (sobel_frame_t){ v->buf, img->rows, img->cols, img->stride, format };
+        return 0;
+    }
+
+    PyBuffer_Release(v);
+    return 1;
+}
+
+// Whether a buffer holds uint16 samples, without keeping the view
+static int is_uint16(PyObject *obj) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(obj, &view, PyBUF_STRIDES | PyBUF_FORMAT) != 0) {
+        PyErr_Clear();
+        return 0;
+    }
+
+    const char *f = view.format ? view.format : "B";
+    if (f[0] == '=' || f[0] == '<' || f[0] == '@') f++;
+    int wide = view.itemsize == 2 && strcmp(f, "H") == 0;
+    PyBuffer_Release(&view);
+    return wide;
+}
+
+// --- Kernels ---
+
+static int get_operator(const char *name, sobel_op_t *op) {
+    *op = name ? sobel_op_from_name(name) : SOBEL_OP_SOBEL;
+    if (*op == SOBEL_OP_COUNT) {
+        PyErr_Format(PyExc_ValueError, "unknown operator '%s'", name);
+        return 1;
+    }
+    return 0;
+}
+
+// uint16 input: 8-bit output scaled by bits - 8 + scale_shift, or the 16-bit magnitude if wide
+static PyObject *magnitude16(PyObject *image_obj, PyObject *out_obj, sobel_op_t op, int blur, const char *format,
+                             int bits, int scale_shift, int wide, sobel_norm_t norm) {
+    PyObject *result = NULL;
+    image_arg_t in, out;
+    int status;
+
+    if (blur != SOBEL_BLUR_NONE || (format && strcmp(format, "gray8") != 0)) {
+        PyErr_SetString(PyExc_ValueError, "uint16 images are grayscale and take no blur");
+        return NULL;
+    }
+    if (bits < 8 || bits > 16 || scale_shift < 0 || scale_shift > 2) {
+        PyErr_SetString(PyExc_ValueError, "bits must be 8 to 16 and scale_shift 0, 1 or 2");
+        return NULL;
+    }
+    if (get_image(image_obj, "H", 0, &in, "image") != 0) {
+        return NULL;
+    }
+    if (get_output(out_obj, wide ? "H" : "B", in.rows, in.cols, &out, &result, "out") != 0) {
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+    if (check_no_overlap(&out, &in, "out", "the image") != 0) {
+        PyBuffer_Release(&in.view);
+        PyBuffer_Release(&out.view);
+        Py_DECREF(result);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    if (wide) {
+        status = sobel_op_magnitude16_wide(op, in.view.buf, in.rows, in.cols, in.stride, out.view.buf, out.stride, norm);
+    } else {
+        status = sobel_op_magnitude16(op, in.view.buf, in.rows, in.cols, in.stride, bits, scale_shift,
+                                      out.view.buf, out.stride, norm);
+    }
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in.view);
+    PyBuffer_Release(&out.view);
+    if (status != 0) {
+        Py_DECREF(result);
+        return PyErr_NoMemory();
+    }
+    return result;
+}
+
+static PyObject *magnitude(PyObject *args, PyObject *kwargs, sobel_norm_t norm) {
+    static char *keywords[] = {"image", "out", "operator", "blur", "format", "bits", "scale_shift", "wide", NULL};
+    PyObject *image_obj, *out_obj = NULL, *result = NULL;
+    const char *op_name = NULL, *format = NULL;
+    int blur = SOBEL_BLUR_NONE, bits = 16, scale_shift = 0, wide = 0;
+    image_arg_t in, out;
+    sobel_frame_t frame;
+    sobel_op_t op;
+    int status;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|Oziziip", keywords, &image_obj, &out_obj, &op_name, &blur,
+                                     &format, &bits, &scale_shift, &wide)) {
+        return NULL;
+    }
+    if (get_operator(op_name, &op) != 0) {
+        return NULL;
+    }
+    if (is_uint16(image_obj)) {
+        return magnitude16(image_obj, out_obj, op, blur, format, bits, scale_shift, wide, norm);
+    }
+    if (blur != SOBEL_BLUR_NONE && blur != SOBEL_BLUR_3X3 && blur != SOBEL_BLUR_5X5) {
+        PyErr_SetString(PyExc_ValueError, "blur must be 0, 3 or 5");
+        return NULL;
+    }
+    if (get_frame(image_obj, format, &in, &frame) != 0) {
+        return NULL;
+    }
+    if (get_output(out_obj, "B", in.rows, in.cols, &out, &result, "out") != 0) {
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+
+    // out=image overwrites the input, which needs the in-place kernel; any other overlap is refused
+    int in_place = frame.format == SOBEL_PIX_GRAY8 && out.view.buf == in.view.buf && out.stride == in.stride;
+    if (!in_place && views_overlap(&in.view, &out.view)) {
+        PyErr_SetString(PyExc_ValueError, "out must be the image itself or not overlap it");
+        PyBuffer_Release(&in.view);
+        PyBuffer_Release(&out.view);
+        Py_DECREF(result);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    if (in_place) {
+        status = sobel_op_magnitude_inplace(op, blur, out.view.buf, in.rows, in.cols, in.stride, norm);
+    } else {
+        status = sobel_op_frame_magnitude(op, blur, &frame, out.view.buf, out.stride, norm);
+    }
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in.view);
+    PyBuffer_Release(&out.view);
+    if (status != 0) {
+        Py_DECREF(result);
+        return PyErr_NoMemory();
+    }
+    return result;
+}
+
+static PyObject *py_manhattan(PyObject *self, PyObject *args, PyObject *kwargs) {
+    return magnitude(args, kwargs, SOBEL_NORM_MANHATTAN);
+}
+
+static PyObject *py_euclidean(PyObject *self, PyObject *args, PyObject *kwargs) {
+    return magnitude(args, kwargs, SOBEL_NORM_EUCLIDEAN);
+}
+
+static PyObject *py_gradients(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"image", "gx", "gy", "operator", NULL};
+    PyObject *image_obj, *gx_obj = NULL, *gy_obj = NULL, *gx_res = NULL, *gy_res = NULL;
+    const char *op_name = NULL;
+    image_arg_t in, gx, gy;
+    sobel_op_t op;
+    int status;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|OOz", keywords, &image_obj, &gx_obj, &gy_obj, &op_name)) {
+        return NULL;
+    }
+    if (get_operator(op_name, &op) != 0) {
+        return NULL;
+    }
+    if (get_image(image_obj, "B", 0, &in, "image") != 0) {
+        return NULL;
+    }
+    if (get_output(gx_obj, "h", in.rows, in.cols, &gx, &gx_res, "gx") != 0) {
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+    if (get_output(gy_obj, "h", in.rows, in.cols, &gy, &gy_res, "gy") != 0) {
+        PyBuffer_Release(&in.view);
+        PyBuffer_Release(&gx.view);
+        Py_DECREF(gx_res);
+        return NULL;
+    }
+    int invalid = gx.stride != gy.stride;
+    if (invalid) {
+        PyErr_SetString(PyExc_ValueError, "gx and gy must have the same row stride");
+    } else {
+        invalid = check_no_overlap(&gx, &in, "gx", "the image") || check_no_overlap(&gy, &in, "gy", "the image")
+                  || check_no_overlap(&gx, &gy, "gx", "gy");
+    }
+    if (invalid) {
+        PyBuffer_Release(&in.view);
+        PyBuffer_Release(&gx.view);
+        PyBuffer_Release(&gy.view);
+        Py_DECREF(gx_res);
+        Py_DECREF(gy_res);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    status = sobel_op_gradients(op, in.view.buf, in.rows, in.cols, in.stride, gx.view.buf, gy.view.buf, gx.stride);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in.view);
+    PyBuffer_Release(&gx.view);
+    PyBuffer_Release(&gy.view);
+    if (status != 0) {
+        Py_DECREF(gx_res);
+        Py_DECREF(gy_res);
+        return PyErr_NoMemory();
+    }
+    return Py_BuildValue("(NN)", gx_res, gy_res);
+}
+
+static PyObject *py_edges(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"image", "low", "high", "operator", "blur", "out", "format", NULL};
+    PyObject *image_obj, *out_obj = NULL, *result = NULL;
+    const char *op_name = NULL, *format = NULL;
+    int low, high, blur = SOBEL_BLUR_NONE, status;
+    image_arg_t in, out;
+    sobel_frame_t frame;
+    sobel_op_t op;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "Oii|ziOz", keywords, &image_obj, &low, &high, &op_name, &blur, &out_obj, &format)) {
+        return NULL;
+    }
+    if (get_operator(op_name, &op) != 0) {
+        return NULL;
+    }
+    if (blur != SOBEL_BLUR_NONE && blur != SOBEL_BLUR_3X3 && blur != SOBEL_BLUR_5X5) {
+        PyErr_SetString(PyExc_ValueError, "blur must be 0, 3 or 5");
+        return NULL;
+    }
+    if (low < 0 || high < low) {
+        PyErr_SetString(PyExc_ValueError, "thresholds must satisfy 0 <= low <= high");
+        return NULL;
+    }
+    if (get_frame(image_obj, format, &in, &frame) != 0) {
+        return NULL;
+    }
+    if (get_output(out_obj, "B", in.rows, in.cols, &out, &result, "out") != 0) {
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+    if (check_no_overlap(&out, &in, "out", "the image") != 0) {
+        PyBuffer_Release(&in.view);
+        PyBuffer_Release(&out.view);
+        Py_DECREF(result);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    status = sobel_edges_frame(op, blur, &frame, out.view.buf, out.stride, low, high);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in.view);
+    PyBuffer_Release(&out.view);
+    if (status != 0) {
+        Py_DECREF(result);
+        return PyErr_NoMemory();
+    }
+    return result;
+}
+
+static PyObject *py_density(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"image", "cell", "threshold", "operator", "blur", "norm", "format", "out", NULL};
+    PyObject *image_obj, *out_obj = NULL, *sum_res = NULL, *count_res = NULL;
+    const char *op_name = NULL, *norm_name = NULL, *format = NULL;
+    int cell = 16, threshold = 64, blur = SOBEL_BLUR_NONE, grid_rows, grid_cols, status;
+    image_arg_t in, out, sum, count;
+    sobel_frame_t frame;
+    sobel_op_t op;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|iiziszO", keywords, &image_obj, &cell, &threshold, &op_name,
+                                     &blur, &norm_name, &format, &out_obj)) {
+        return NULL;
+    }
+    if (get_operator(op_name, &op) != 0) {
+        return NULL;
+    }
+    if (norm_name && strcmp(norm_name, "manhattan") != 0 && strcmp(norm_name, "euclidean") != 0) {
+        PyErr_Format(PyExc_ValueError, "unknown norm '%s'", norm_name);
+        return NULL;
+    }
+    sobel_norm_t norm = norm_name && strcmp(norm_name, "euclidean") == 0 ? SOBEL_NORM_EUCLIDEAN : SOBEL_NORM_MANHATTAN;
+    if (blur != SOBEL_BLUR_NONE && blur != SOBEL_BLUR_3X3 && blur != SOBEL_BLUR_5X5) {
+        PyErr_SetString(PyExc_ValueError, "blur must be 0, 3 or 5");
+        return NULL;
+    }
+
+    if (get_frame(image_obj, format, &in, &frame) != 0) {
+        return NULL;
+    }
+    if (sobel_density_dims(in.rows, in.cols, cell, &grid_rows, &grid_cols) != 0) {
+        PyErr_SetString(PyExc_ValueError, "cell must be 1 to 4096");
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+    if (get_output(NULL, "I", grid_rows, grid_cols, &sum, &sum_res, "sum") != 0) {
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+    if (get_output(NULL, "I", grid_rows, grid_cols, &count, &count_res, "count") != 0) {
+        PyBuffer_Release(&in.view);
+        PyBuffer_Release(&sum.view);
+        Py_DECREF(sum_res);
+        return NULL;
+    }
+
+    // The magnitude image is only written when asked for
+    int has_out = out_obj && out_obj != Py_None;
+    PyObject *out_res = NULL;
+    if (has_out && get_output(out_obj, "B", in.rows, in.cols, &out, &out_res, "out") != 0) {
+        PyBuffer_Release(&in.view);
+        PyBuffer_Release(&sum.view);
+        PyBuffer_Release(&count.view);
+        Py_DECREF(sum_res);
+        Py_DECREF(count_res);
+        return NULL;
+    }
+    if (has_out && check_no_overlap(&out, &in, "out", "the image") != 0) {
+        PyBuffer_Release(&in.view);
+        PyBuffer_Release(&sum.view);
+        PyBuffer_Release(&count.view);
+        PyBuffer_Release(&out.view);
+        Py_DECREF(sum_res);
+        Py_DECREF(count_res);
+        Py_DECREF(out_res);
+        return NULL;
+    }
+
+    sobel_density_t density = { cell, threshold, sum.view.buf, count.view.buf };
+
+    Py_BEGIN_ALLOW_THREADS
+    status = sobel_op_density(op, blur, &frame, has_out ? out.view.buf : NULL, has_out ? out.stride : 0, norm, &density);
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in.view);
+    PyBuffer_Release(&sum.view);
+    PyBuffer_Release(&count.view);
+    if (has_out) {
+        PyBuffer_Release(&out.view);
+        Py_DECREF(out_res);
+    }
+    if (status != 0) {
+        Py_DECREF(sum_res);
+        Py_DECREF(count_res);
+        return PyErr_NoMemory();
+    }
+    return Py_BuildValue("(NN)", sum_res, count_res);
+}
+
+static PyObject *py_hog(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"image", "cell", "bins", "operator", "blur", "norm", "format", NULL};
+    PyObject *image_obj;
+    const char *op_name = NULL, *norm_name = NULL, *format = NULL;
+    int cell = 8, bins = 9, blur = SOBEL_BLUR_NONE, grid_rows, grid_cols, status;
+    image_arg_t in;
+    sobel_frame_t frame;
+    sobel_op_t op;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|iiziss", keywords, &image_obj, &cell, &bins, &op_name,
+                                     &blur, &norm_name, &format)) {
+        return NULL;
+    }
+    if (get_operator(op_name, &op) != 0) {
+        return NULL;
+    }
+    if (norm_name && strcmp(norm_name, "manhattan") != 0 && strcmp(norm_name, "euclidean") != 0) {
+        PyErr_Format(PyExc_ValueError, "unknown norm '%s'", norm_name);
+        return NULL;
+    }
+    sobel_norm_t norm = norm_name && strcmp(norm_name, "euclidean") == 0 ? SOBEL_NORM_EUCLIDEAN : SOBEL_NORM_MANHATTAN;
+    if (blur != SOBEL_BLUR_NONE && blur != SOBEL_BLUR_3X3 && blur != SOBEL_BLUR_5X5) {
+        PyErr_SetString(PyExc_ValueError, "blur must be 0, 3 or 5");
+        return NULL;
+    }
+    if (bins < 1 || bins > SOBEL_HOG_MAX_BINS || cell > SOBEL_HOG_MAX_CELL) {
+        PyErr_Format(PyExc_ValueError, "bins must be 1 to %d and cell 1 to %d", SOBEL_HOG_MAX_BINS, SOBEL_HOG_MAX_CELL);
+        return NULL;
+    }
+
+    if (get_frame(image_obj, format, &in, &frame) != 0) {
+        return NULL;
+    }
+    if (sobel_density_dims(in.rows, in.cols, cell, &grid_rows, &grid_cols) != 0) {
+        PyErr_SetString(PyExc_ValueError, "cell must be at least 1");
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+
+    // grid rows x grid cols x bins, returned as a 3-D memoryview
+    PyObject *bytes = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t)grid_rows * grid_cols * bins * sizeof(uint32_t));
+    if (!bytes) {
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    status = sobel_hog(op, blur, &frame, cell, bins, norm, (uint32_t *)PyByteArray_AS_STRING(bytes));
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in.view);
+    if (status != 0) {
+        Py_DECREF(bytes);
+        return PyErr_NoMemory();
+    }
+
+    PyObject *flat = PyMemoryView_FromObject(bytes);
+    Py_DECREF(bytes);
+    if (!flat) {
+        return NULL;
+    }
+    PyObject *shaped = PyObject_CallMethod(flat, "cast", "s(iii)", "I", grid_rows, grid_cols, bins);
+    Py_DECREF(flat);
+    return shaped;
+}
+
+static PyObject *py_pyramid(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"image", "levels", "operator", "norm", "format", NULL};
+    PyObject *image_obj;
+    const char *op_name = NULL, *norm_name = NULL, *format = NULL;
+    int levels = 3, status;
+    image_arg_t in;
+    sobel_frame_t frame;
+    sobel_pyramid_t pyramid;
+    sobel_op_t op;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|izss", keywords, &image_obj, &levels, &op_name,
+                                     &norm_name, &format)) {
+        return NULL;
+    }
+    if (get_operator(op_name, &op) != 0) {
+        return NULL;
+    }
+    if (norm_name && strcmp(norm_name, "manhattan") != 0 && strcmp(norm_name, "euclidean") != 0) {
+        PyErr_Format(PyExc_ValueError, "unknown norm '%s'", norm_name);
+        return NULL;
+    }
+    sobel_norm_t norm = norm_name && strcmp(norm_name, "euclidean") == 0 ? SOBEL_NORM_EUCLIDEAN : SOBEL_NORM_MANHATTAN;
+
+    if (get_frame(image_obj, format, &in, &frame) != 0) {
+        return NULL;
+    }
+    if (sobel_pyramid_layout(in.rows, in.cols, levels, &pyramid) != 0) {
+        PyErr_Format(PyExc_ValueError, "levels must be 1 to %d", SOBEL_PYRAMID_MAX_LEVELS);
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+
+    // One arena for all levels; each level is returned as a 2-D view into it
+    PyObject *bytes = PyByteArray_FromStringAndSize(NULL, (Py_ssize_t)pyramid.bytes);
+    if (!bytes) {
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    status = sobel_op_pyramid(op, &frame, norm, &pyramid, (uint8_t *)PyByteArray_AS_STRING(bytes));
+    Py_END_ALLOW_THREADS
+
+    PyBuffer_Release(&in.view);
+    if (status != 0) {
+        Py_DECREF(bytes);
+        return PyErr_NoMemory();
+    }
+
+    PyObject *arena = PyMemoryView_FromObject(bytes);
+    PyObject *result = arena ? PyList_New(pyramid.levels) : NULL;
+    Py_DECREF(bytes);
+
+    for (int l = 0; result && l < pyramid.levels; l++) {
+        Py_ssize_t start = (Py_ssize_t)pyramid.offset[l];
+        Py_ssize_t end = start + (Py_ssize_t)pyramid.rows[l] * pyramid.cols[l];
+        PyObject *flat = PySequence_GetSlice(arena, start, end);
+        PyObject *level = flat ? PyObject_CallMethod(flat, "cast", "s(ii)", "B", pyramid.rows[l], pyramid.cols[l]) : NULL;
+        Py_XDECREF(flat);
+        if (!level) {
+            Py_CLEAR(result);
+        } else {
+            PyList_SET_ITEM(result, l, level);
+        }
+    }
+
+    Py_XDECREF(arena);
+    return result;
+}
+
+static PyObject *py_hardware(PyObject *self, PyObject *args, PyObject *kwargs) {
+    static char *keywords[] = {"image", "scale_shift", "threads", "out", NULL};
+    PyObject *image_obj, *out_obj = NULL, *result = NULL;
+    int shift = SOBEL_HW_SCALE_NONE, threads = 1, status;
+    image_arg_t in, out;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|iiO", keywords, &image_obj, &shift, &threads, &out_obj)) {
+        return NULL;
+    }
+    if (shift < SOBEL_HW_SCALE_NONE || shift > SOBEL_HW_SCALE_DIV4) {
+        PyErr_SetString(PyExc_ValueError, "scale_shift must be 0, 1 or 2");
+        return NULL;
+    }
+    if (get_image(image_obj, "B", 0, &in, "image") != 0) {
+        return NULL;
+    }
+
+    // The core consumes one contiguous stream
+    if (in.stride != (size_t)in.cols || in.rows < 3 || in.cols < 3) {
+        PyErr_SetString(PyExc_ValueError, "image must be C-contiguous and at least 3 x 3");
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+    if (get_output(out_obj, "B", in.rows - 2, in.cols - 2, &out, &result, "out") != 0) {
+        PyBuffer_Release(&in.view);
+        return NULL;
+    }
+    if (out.stride != (size_t)out.cols) {
+        PyErr_SetString(PyExc_ValueError, "out must be C-contiguous");
+        status = -1;
+    } else if (check_no_overlap(&out, &in, "out", "the image") != 0) {
+        status = -1;
+    } else {
+        Py_BEGIN_ALLOW_THREADS
+        status = sobel_hw_frame(in.view.buf, out.view.buf, in.rows, in.cols, shift, threads);
+        Py_END_ALLOW_THREADS
+
+        if (status != 0) {
+            PyErr_NoMemory();
+        }
+    }
+
+    PyBuffer_Release(&in.view);
+    PyBuffer_Release(&out.view);
+    if (status != 0) {
+        Py_DECREF(result);
+        return NULL;
+    }
+    return result;
+}
+
+// --- Module ---
+
+static PyMethodDef sobel_native_methods[] = {
+    {"manhattan", (PyCFunction)(void (*)(void))py_manhattan, METH_VARARGS | METH_KEYWORDS,
+     "manhattan(image, out=None, operator='sobel', blur=0, format='gray8', bits=16, scale_shift=0, wide=False)\n--\n\n"
+     "|Gx| + |Gy| saturated at 255, borders clamped, as sobel_manhattan(). Returns uint8 rows x cols.\n"
+     "operator is 'sobel', 'scharr', 'prewitt' or 'sobel5'; the others are scaled to the Sobel gain.\n"
+     "blur=3 or 5 applies a fused Gaussian blur first. out=image computes in place; any other out\n"
+     "overlapping the image raises ValueError. format is 'gray8', 'rgb24', 'bgr24', 'i420' or\n"
+     "'nv12'; colour is reduced to BT.601 luma on the fly.\n"
+     "uint16 images hold `bits`-bit samples and give uint8 scaled by bits - 8 + scale_shift, or with\n"
+     "wide=True the uint16 magnitude at full range."},
+    {"euclidean", (PyCFunction)(void (*)(void))py_euclidean, METH_VARARGS | METH_KEYWORDS,
+     "euclidean(image, out=None, operator='sobel', blur=0, format='gray8', bits=16, scale_shift=0, wide=False)\n--\n\n"
+     "round(sqrt(Gx^2 + Gy^2)) saturated at 255, as sobel_euclidean(). Returns uint8 rows x cols."},
+    {"gradients", (PyCFunction)(void (*)(void))py_gradients, METH_VARARGS | METH_KEYWORDS,
+     "gradients(image, gx=None, gy=None, operator='sobel')\n--\n\n"
+     "Raw gradients with clamped borders, unscaled. Returns (gx, gy), int16 rows x cols."},
+    {"edges", (PyCFunction)(void (*)(void))py_edges, METH_VARARGS | METH_KEYWORDS,
+     "edges(image, low, high, operator='sobel', blur=0, out=None, format='gray8')\n--\n\n"
+     "Thin edge map (NMS + hysteresis on |Gx| + |Gy|), fused with the gradient pass. Returns uint8 0/255."},
+    {"density", (PyCFunction)(void (*)(void))py_density, METH_VARARGS | METH_KEYWORDS,
+     "density(image, cell=16, threshold=64, operator='sobel', blur=0, norm='manhattan', format='gray8', out=None)\n--\n\n"
+     "Coarse edge map computed in the same pass as the magnitude: per cell x cell block, the summed\n"
+     "magnitude and the count of pixels >= threshold. Returns (sum, count), uint32 grids; the\n"
+     "magnitude image is also written when out is given."},
+    {"hog", (PyCFunction)(void (*)(void))py_hog, METH_VARARGS | METH_KEYWORDS,
+     "hog(image, cell=8, bins=9, operator='sobel', blur=0, norm='manhattan', format='gray8')\n--\n\n"
+     "Per-cell histograms of unsigned gradient orientation (0 to 180 degrees) weighted by magnitude,\n"
+     "computed in the gradient sweep. Returns uint32 grid rows x grid cols x bins."},
+    {"pyramid", (PyCFunction)(void (*)(void))py_pyramid, METH_VARARGS | METH_KEYWORDS,
+     "pyramid(image, levels=3, operator='sobel', norm='manhattan', format='gray8')\n--\n\n"
+     "Magnitude at full, 1/2, 1/4 ... resolution (2x2 averaging) from one pass over the image.\n"
+     "Returns a list of uint8 2-D views, all into one buffer."},
+    {"hardware", (PyCFunction)(void (*)(void))py_hardware, METH_VARARGS | METH_KEYWORDS,
+     "hardware(image, scale_shift=0, threads=1, out=None)\n--\n\n"
+     "Bit-exact output stream of the Sobel IP core. Returns uint8 (rows-2) x (cols-2)."},
+    {NULL, NULL, 0, NULL}
+};
+
+static struct PyModuleDef sobel_native_module = {
+    PyModuleDef_HEAD_INIT,
+    "sobel_native",
+    "Zero-copy bindings for the sobel_software kernels.",
+    -1,
+    sobel_native_methods
+};
+
+PyMODINIT_FUNC PyInit_sobel_native(void) {
+    return PyModule_Create(&sobel_native_module);
+}
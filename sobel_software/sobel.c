@@ -4,57 +4,143 @@
 #include <stdio.h>
 #include <math.h>
 #include <stdint.h>
+#include <string.h>
 
 // --- Sobel Kernels ---
-static const int Gx[3][3] = {{-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1}};
-static const int Gy[3][3] = {{-1, -2, -1}, {0, 0, 0}, {1, 2, 1}};
+// Gx = {{-1, 0, 1}, {-2, 0, 2}, {-1, 0, 1}}
+// Gy = {{-1, -2, -1}, {0, 0, 0}, {1, 2, 1}}
+// Borders are handled by clamping to the nearest edge pixel.
 
 // --- Sobel Processing ---
-static int get_padded_pixel(uint8_t input[ROW][COLUMN], int row, int col) {
-    // Handle border by mirroring
-    int r = row < 0 ? 0 : (row >= ROW ? ROW - 1 : row);
-    int c = col < 0 ? 0 : (col >= COLUMN ? COLUMN - 1 : col);
-    return input[r][c];
+void sobel_manhattan(uint8_t input[ROW][COLUMN], uint8_t output[ROW][COLUMN]) {
+    sobel_magnitude(&input[0][0], ROW, COLUMN, COLUMN, &output[0][0], COLUMN, SOBEL_NORM_MANHATTAN);
 }
 
-void sobel_manhattan(uint8_t input[ROW][COLUMN], uint8_t output[ROW][COLUMN]) {
-    for (int r = 0; r < ROW; r++) {
-        for (int c = 0; c < COLUMN; c++) {
-            int sx = 0, sy = 0;
-            
-            // Apply Sobel kernel
-            for (int i = -1; i <= 1; i++) {
-                for (int j = -1; j <= 1; j++) {
-                    int pixel = get_padded_pixel(input, r + i, c + j);
-                    sx += pixel * Gx[i + 1][j + 1];
-                    sy += pixel * Gy[i + 1][j + 1];
-                }
+void sobel_euclidean(uint8_t input[ROW][COLUMN], uint8_t output[ROW][COLUMN]) {
+    sobel_magnitude(&input[0][0], ROW, COLUMN, COLUMN, &output[0][0], COLUMN, SOBEL_NORM_EUCLIDEAN);
+}
+
+// --- Any frame size ---
+// Gx and Gy expanded on row pointers, left/right columns clamped
+
+static void sobel_row(const uint8_t *up, const uint8_t *mid, const uint8_t *down, int cols, int c, int *sx, int *sy) {
+    int l = c > 0 ? c - 1 : 0;
+    int r = c < cols - 1 ? c + 1 : cols - 1;
+
+    *sx = (up[r] - up[l]) + 2 * (mid[r] - mid[l]) + (down[r] - down[l]);
+    *sy = (down[l] + 2 * down[c] + down[r]) - (up[l] + 2 * up[c] + up[r]);
+}
+
+// Output rows r0 .. r1 - 1, columns c0 .. c1 - 1 of a frame
+static void sobel_tile(const uint8_t *input, int rows, int cols, size_t in_stride, uint8_t *output,
+                       size_t out_stride, sobel_norm_t norm, int r0, int r1, int c0, int c1) {
+    for (int r = r0; r < r1; r++) {
+        const uint8_t *up = input + (size_t)(r > 0 ? r - 1 : 0) * in_stride;
+        const uint8_t *mid = input + (size_t)r * in_stride;
+        const uint8_t *down = input + (size_t)(r < rows - 1 ? r + 1 : rows - 1) * in_stride;
+        uint8_t *out = output + (size_t)r * out_stride;
+
+        for (int c = c0; c < c1; c++) {
+            int sx, sy, magnitude;
+            sobel_row(up, mid, down, cols, c, &sx, &sy);
+
+            if (norm == SOBEL_NORM_EUCLIDEAN) {
+                magnitude = (int)(sqrt(sx * sx + sy * sy) + 0.5);
+            } else {
+                magnitude = abs(sx) + abs(sy);
             }
-            
-            // Manhattan magnitude and clamp to 0-255
-            int magnitude = abs(sx) + abs(sy);
-            output[r][c] = magnitude > 255 ? 255 : magnitude;
+            out[c] = magnitude > 255 ? 255 : magnitude;
         }
     }
 }
 
-void sobel_euclidean(uint8_t input[ROW][COLUMN], uint8_t output[ROW][COLUMN]) {
-    for (int r = 0; r < ROW; r++) {
-        for (int c = 0; c < COLUMN; c++) {
-            int sx = 0, sy = 0;
-            
-            // Apply Sobel kernel
-            for (int i = -1; i <= 1; i++) {
-                for (int j = -1; j <= 1; j++) {
-                    int pixel = get_padded_pixel(input, r + i, c + j);
-                    sx += pixel * Gx[i + 1][j + 1];
-                    sy += pixel * Gy[i + 1][j + 1];
+void sobel_magnitude(const uint8_t *input, int rows, int cols, size_t in_stride,
+                     uint8_t *output, size_t out_stride, sobel_norm_t norm) {
+    sobel_tile(input, rows, cols, in_stride, output, out_stride, norm, 0, rows, 0, cols);
+}
+
+// --- Flat segments ---
+// An output pixel whose 3x3 neighbourhood holds one value has zero gradients (clamped borders only
+// repeat pixels of the neighbourhood). The frame is walked row by row as in sobel_magnitude. Each
+// input row is scanned once, when it enters the three-row window, for which segments of `tile`
+// columns (plus a one-pixel halo) hold a single value, and the result serves the three output rows
+// that read it. An output segment whose three input segments hold the same value is cleared
+// instead of convolved. The scan ORs the XOR of a segment with its first pixel, which vectorises.
+
+static void scan_row(const uint8_t *row, int cols, int tile, int16_t *value) {
+    for (int s = 0, c0 = 0; c0 < cols; s++, c0 += tile) {
+        int h0 = c0 > 0 ? c0 - 1 : 0;
+        int h1 = c0 + tile < cols ? c0 + tile + 1 : cols;
+        uint8_t v = row[h0], diff = 0;
+        for (int c = h0; c < h1; c++) {
+            diff |= row[c] ^ v;
+        }
+        value[s] = diff ? -1 : v;
+    }
+}
+
+void sobel_magnitude_skip_flat(const uint8_t *input, int rows, int cols, size_t in_stride,
+                               uint8_t *output, size_t out_stride, sobel_norm_t norm,
+                               int tile, sobel_tile_stats_t *stats) {
+    tile = tile > 0 ? tile : SOBEL_FLAT_TILE;
+    int segments = (cols + tile - 1) / tile;
+    long flat = 0;
+
+    // Segment values of the three rows in the window, input row r in slot r % 3
+    int16_t *value = malloc(3 * (size_t)segments * sizeof(int16_t));
+    if (!value) {
+        sobel_magnitude(input, rows, cols, in_stride, output, out_stride, norm);
+    }
+
+    for (int r = 0; value && r < rows; r++) {
+        if (r == 0) {
+            scan_row(input, cols, tile, value);
+        }
+        if (r + 1 < rows) {
+            scan_row(input + (size_t)(r + 1) * in_stride, cols, tile, value + (size_t)((r + 1) % 3) * segments);
+        }
+        const int16_t *up = value + (size_t)((r > 0 ? r - 1 : 0) % 3) * segments;
+        const int16_t *mid = value + (size_t)(r % 3) * segments;
+        const int16_t *down = value + (size_t)((r < rows - 1 ? r + 1 : r) % 3) * segments;
+        uint8_t *out = output + (size_t)r * out_stride;
+
+        // Consecutive segments that need the kernel go through it in one call
+        int run = 0;
+        for (int s = 0; s < segments; s++) {
+            int c0 = s * tile;
+            if (mid[s] >= 0 && up[s] == mid[s] && down[s] == mid[s]) {
+                if (run < c0) {
+                    sobel_tile(input, rows, cols, in_stride, output, out_stride, norm, r, r + 1, run, c0);
                 }
+                memset(out + c0, 0, (size_t)((c0 + tile < cols ? c0 + tile : cols) - c0));
+                run = c0 + tile;
+                flat++;
             }
-            
-            // Euclidean magnitude and clamp to 0-255
-            int magnitude = (int)(sqrt(sx * sx + sy * sy) + 0.5);
-            output[r][c] = magnitude > 255 ? 255 : magnitude;
+        }
+        if (run < cols) {
+            sobel_tile(input, rows, cols, in_stride, output, out_stride, norm, r, r + 1, run, cols);
+        }
+    }
+    free(value);
+
+    if (stats) {
+        stats->tiles = (long)rows * segments;
+        stats->flat = flat;
+    }
+}
+
+void sobel_gradients(const uint8_t *input, int rows, int cols, size_t in_stride,
+                     int16_t *gx, int16_t *gy, size_t out_stride) {
+    for (int r = 0; r < rows; r++) {
+        const uint8_t *up = input + (size_t)(r > 0 ? r - 1 : 0) * in_stride;
+        const uint8_t *mid = input + (size_t)r * in_stride;
+        const uint8_t *down = input + (size_t)(r < rows - 1 ? r + 1 : rows - 1) * in_stride;
+
+        for (int c = 0; c < cols; c++) {
+            int sx, sy;
+            sobel_row(up, mid, down, cols, c, &sx, &sy);
+            gx[(size_t)r * out_stride + c] = (int16_t)sx;
+            gy[(size_t)r * out_stride + c] = (int16_t)sy;
         }
     }
 }
\ No newline at end of file
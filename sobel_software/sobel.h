@@ -20,4 +20,66 @@ void sobel_manhattan(uint8_t input[ROW][COLUMN], uint8_t output[ROW][COLUMN]);
  */
 void sobel_euclidean(uint8_t input[ROW][COLUMN], uint8_t output[ROW][COLUMN]);
 
+// --- Any frame size ---
+// Borders are clamped as above. Strides are in elements, so views into larger buffers work.
+
+typedef enum {
+    SOBEL_NORM_MANHATTAN,       // |Gx| + |Gy|
+    SOBEL_NORM_EUCLIDEAN        // sqrt(Gx² + Gy²), rounded
+} sobel_norm_t;
+
+/**
+ * Apply the Sobel filter to a frame of any size, saturating the magnitude at 255
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param output First output pixel, rows x cols
+ * @param out_stride Output row stride in pixels
+ * @param norm Magnitude norm
+ */
+void sobel_magnitude(const uint8_t *input, int rows, int cols, size_t in_stride,
+                     uint8_t *output, size_t out_stride, sobel_norm_t norm);
+
+// --- Flat segments ---
+// Uniform areas (document scans, overlays) have zero gradients, so whole row segments can be
+// cleared without convolving them
+
+#define SOBEL_FLAT_TILE 32
+
+typedef struct {
+    long tiles;                 // row segments processed
+    long flat;                  // row segments found uniform and cleared
+} sobel_tile_stats_t;
+
+/**
+ * Same as sobel_magnitude, bit-exact, but row segments whose 3x3 neighbourhoods all hold one
+ * value are set to zero instead of being convolved
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param output First output pixel, rows x cols
+ * @param out_stride Output row stride in pixels
+ * @param norm Magnitude norm
+ * @param tile Segment width in pixels, or 0 for SOBEL_FLAT_TILE
+ * @param stats Segment counts, may be NULL
+ */
+void sobel_magnitude_skip_flat(const uint8_t *input, int rows, int cols, size_t in_stride,
+                               uint8_t *output, size_t out_stride, sobel_norm_t norm,
+                               int tile, sobel_tile_stats_t *stats);
+
+/**
+ * Compute the raw Sobel gradients of a frame of any size
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param gx Horizontal gradient, rows x cols, range -1020 .. 1020
+ * @param gy Vertical gradient, rows x cols, range -1020 .. 1020
+ * @param out_stride Gradient row stride in elements
+ */
+void sobel_gradients(const uint8_t *input, int rows, int cols, size_t in_stride,
+                     int16_t *gx, int16_t *gy, size_t out_stride);
+
 #endif // SOBEL_H
\ No newline at end of file
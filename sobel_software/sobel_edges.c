@@ -0,0 +1,181 @@
+#include "sobel_edges.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define EDGE_WEAK 128
+
+// tan(22.5) ~ 53/128 and tan(67.5) ~ 309/128
+#define TAN_22_5_Q7  53
+#define TAN_67_5_Q7  309
+
+typedef struct {
+    int *items;              // row, column pairs
+    size_t count;
+    size_t capacity;
+} edge_stack_t;
+
+static int stack_push(edge_stack_t *s, int r, int c) {
+    if (s->count == s->capacity) {
+        size_t capacity = s->capacity ? 2 * s->capacity : 1024;
+        int *items = realloc(s->items, capacity * 2 * sizeof(int));
+        if (!items) return 1;
+        s->items = items;
+        s->capacity = capacity;
+    }
+    s->items[2 * s->count] = r;
+    s->items[2 * s->count + 1] = c;
+    s->count++;
+    return 0;
+}
+
+// Grow edges from the stacked pixels through weak pixels, over rows 0 .. last only
+static int stack_drain(edge_stack_t *s, uint8_t *edges, size_t stride, int last, int cols) {
+    while (s->count) {
+        s->count--;
+        int r = s->items[2 * s->count], c = s->items[2 * s->count + 1];
+
+        for (int y = r > 0 ? r - 1 : 0; y <= r + 1 && y <= last; y++) {
+            uint8_t *row = edges + (size_t)y * stride;
+            for (int x = c > 0 ? c - 1 : 0; x <= c + 1 && x < cols; x++) {
+                if (row[x] == EDGE_WEAK) {
+                    row[x] = SOBEL_EDGE;
+                    if (stack_push(s, y, x) != 0) return 1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+// Magnitude row with one zero pixel of padding on each side
+static void magnitude_row(const int16_t *gx, const int16_t *gy, int cols, int shift, uint16_t *mag) {
+    mag[0] = 0;
+    mag[cols + 1] = 0;
+    for (int c = 0; c < cols; c++) {
+        int ax = gx[c] < 0 ? -gx[c] : gx[c];
+        int ay = gy[c] < 0 ? -gy[c] : gy[c];
+        mag[c + 1] = (uint16_t)((ax + ay) >> shift);
+    }
+}
+
+int sobel_edges(sobel_op_t op, sobel_blur_t blur, const uint8_t *input, int rows, int cols, size_t in_stride,
+                uint8_t *edges, size_t out_stride, int low, int high) {
+    sobel_frame_t frame = { input, rows, cols, in_stride, SOBEL_PIX_GRAY8 };
+    return sobel_edges_frame(op, blur, &frame, edges, out_stride, low, high);
+}
+
+int sobel_edges_frame(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame,
+                      uint8_t *edges, size_t out_stride, int low, int high) {
+    if (!edges || low < 0 || high < low) {
+        return 1;
+    }
+
+    sobel_op_stream_t *stream = sobel_op_stream_open_frame(op, blur, frame);
+    if (!stream) {
+        return 1;
+    }
+
+    int rows = frame->rows, cols = frame->cols;
+
+    // Two gradient rows (current, next) and three magnitude rows (previous, current, next)
+    size_t n = (size_t)cols + 2;
+    int16_t *grad = malloc(4 * (size_t)cols * sizeof(int16_t));
+    uint16_t *mag = calloc(4 * n, sizeof(uint16_t));
+    edge_stack_t stack = { NULL, 0, 0 };
+    int shift = sobel_op_gain_shift(op);
+    int result = 0;
+
+    if (!grad || !mag) {
+        free(grad);
+        free(mag);
+        sobel_op_stream_close(stream);
+        return 1;
+    }
+
+    int16_t *gx[2] = { grad, grad + cols };
+    int16_t *gy[2] = { grad + 2 * cols, grad + 3 * cols };
+    uint16_t *zero = mag + 3 * n;
+    uint16_t *prev = zero, *cur = mag, *next = mag + n, *spare = mag + 2 * n;
+
+    sobel_op_stream_next(stream, gx[0], gy[0]);
+    magnitude_row(gx[0], gy[0], cols, shift, cur);
+
+    for (int r = 0; r < rows && !result; r++) {
+        const int16_t *rgx = gx[r & 1], *rgy = gy[r & 1];
+        uint8_t *out = edges + (size_t)r * out_stride;
+        const uint8_t *above = r > 0 ? out - out_stride : NULL;
+
+        if (r + 1 < rows) {
+            sobel_op_stream_next(stream, gx[(r + 1) & 1], gy[(r + 1) & 1]);
+            magnitude_row(gx[(r + 1) & 1], gy[(r + 1) & 1], cols, shift, next);
+        } else {
+            next = zero;
+        }
+
+        // Non-maximum suppression and classification
+        for (int c = 0; c < cols; c++) {
+            int m = cur[c + 1];
+            if (m < low || m == 0) {
+                out[c] = SOBEL_NO_EDGE;
+                continue;
+            }
+
+            int ax = rgx[c] < 0 ? -rgx[c] : rgx[c];
+            int ay = rgy[c] < 0 ? -rgy[c] : rgy[c];
+            int a, b;
+
+            if (ay * 128 <= ax * TAN_22_5_Q7) {          // across columns
+                a = cur[c];
+                b = cur[c + 2];
+            } else if (ay * 128 >= ax * TAN_67_5_Q7) {   // across rows
+                a = prev[c + 1];
+                b = next[c + 1];
+            } else if ((rgx[c] ^ rgy[c]) >= 0) {         // down-right / up-left
+                a = prev[c];
+                b = next[c + 2];
+            } else {                                     // down-left / up-right
+                a = prev[c + 2];
+                b = next[c];
+            }
+
+            if (m <= a || m < b) {
+                out[c] = SOBEL_NO_EDGE;
+            } else if (m >= high) {
+                out[c] = SOBEL_EDGE;
+                result |= stack_push(&stack, r, c);
+            } else {
+                // Weak: promote right away if it touches an edge already decided
+                int linked = c > 0 && out[c - 1] == SOBEL_EDGE;
+                for (int x = c > 0 ? c - 1 : 0; above && !linked && x <= c + 1 && x < cols; x++) {
+                    linked = above[x] == SOBEL_EDGE;
+                }
+                out[c] = linked ? SOBEL_EDGE : EDGE_WEAK;
+                if (linked) result |= stack_push(&stack, r, c);
+            }
+        }
+
+        if (!result) {
+            result = stack_drain(&stack, edges, out_stride, r, cols);
+        }
+
+        // Rotate the magnitude window
+        uint16_t *old = prev == zero ? spare : prev;
+        prev = cur;
+        cur = next;
+        next = old;
+    }
+
+    // Weak pixels that never reached a strong one
+    for (int r = 0; r < rows && !result; r++) {
+        uint8_t *out = edges + (size_t)r * out_stride;
+        for (int c = 0; c < cols; c++) {
+            out[c] = out[c] == SOBEL_EDGE ? SOBEL_EDGE : SOBEL_NO_EDGE;
+        }
+    }
+
+    free(stack.items);
+    free(grad);
+    free(mag);
+    sobel_op_stream_close(stream);
+    return result;
+}
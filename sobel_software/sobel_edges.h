@@ -0,0 +1,50 @@
+#ifndef SOBEL_EDGES_H
+#define SOBEL_EDGES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sobel_ops.h"
+
+// --- Thin edges (Canny-style) ---
+// Non-maximum suppression and hysteresis fused with the gradient pass. Gradient rows are
+// streamed from sobel_ops; NMS runs on a rolling window of three magnitude rows with the
+// direction quantised to 0/45/90/135 degrees by integer comparisons of |Gx| and |Gy| (no atan2).
+// Weak pixels are linked to strong ones as each row is decided, through an explicit stack that
+// only ever walks back over rows already written, so the whole frame is done in one sweep plus
+// a byte-wise cleanup of the weak pixels that never connected.
+
+#define SOBEL_EDGE     255
+#define SOBEL_NO_EDGE  0
+
+/**
+ * Compute a thin edge map
+ * @param op Gradient operator
+ * @param blur Fused Gaussian pre-smoothing (SOBEL_BLUR_NONE, SOBEL_BLUR_3X3 or SOBEL_BLUR_5X5)
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param edges Edge map, rows x cols, SOBEL_EDGE or SOBEL_NO_EDGE; must not overlap the input
+ * @param out_stride Edge map row stride in pixels
+ * @param low Hysteresis low threshold on |Gx| + |Gy| (same scale as sobel_op_magnitude, unsaturated)
+ * @param high Hysteresis high threshold, edges start at pixels with magnitude >= high
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_edges(sobel_op_t op, sobel_blur_t blur, const uint8_t *input, int rows, int cols, size_t in_stride,
+                uint8_t *edges, size_t out_stride, int low, int high);
+
+/**
+ * Same as sobel_edges for any input format (see sobel_op_frame_magnitude)
+ * @param op Gradient operator
+ * @param blur Fused Gaussian pre-smoothing
+ * @param frame Input frame
+ * @param edges Edge map, rows x cols; must not overlap the input
+ * @param out_stride Edge map row stride in pixels
+ * @param low Hysteresis low threshold
+ * @param high Hysteresis high threshold
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_edges_frame(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame,
+                      uint8_t *edges, size_t out_stride, int low, int high);
+
+#endif // SOBEL_EDGES_H
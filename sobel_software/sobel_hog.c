@@ -0,0 +1,111 @@
+#include "sobel_hog.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define HOG_Q 14
+
+// Bin and vote of every pixel of a gradient row. The boundaries are symmetric about 90 degrees,
+// so the gradient is folded to 0 .. 90 (gx, gy overwritten with |x|, y), tested against the
+// boundaries up to 90 only, one boundary at a time over the whole row so that each test is a
+// vector compare, then mirrored back. Every bin includes its lower boundary: an unfolded angle
+// counts the boundaries it reaches, a mirrored one only those it passes, so that an angle of
+// 180 - b lands above the boundary at 180 - b rather than below it.
+static void bin_row(int16_t *restrict gx, int16_t *restrict gy, int cols, int bins, const int16_t *bcos, const int16_t *bsin,
+                    int shift, sobel_norm_t norm, uint8_t *restrict bin, uint16_t *restrict vote) {
+    uint8_t *restrict mirror = bin + cols;
+
+    for (int c = 0; c < cols; c++) {
+        int16_t x = gx[c], y = gy[c];
+
+        // Orientation, not direction: fold into the upper half plane, then onto 0 .. 90.
+        // Sign masks rather than branches, the signs of a real image are close to random.
+        int16_t flip = (int16_t)-((y < 0) | ((y == 0) & (x < 0)));
+        x = (int16_t)((x ^ flip) - flip);
+        y = (int16_t)((y ^ flip) - flip);
+        int16_t left = x >> 15;
+        mirror[c] = (uint8_t)(left & 1);
+        gx[c] = (int16_t)((x ^ left) - left);
+        gy[c] = y;
+        bin[c] = 0;
+    }
+
+    if (norm == SOBEL_NORM_EUCLIDEAN) {
+        for (int c = 0; c < cols; c++) {
+            int32_t x = gx[c], y = gy[c];
+            vote[c] = (uint16_t)((int32_t)(sqrt((double)(x * x + y * y)) + 0.5) >> shift);
+        }
+    } else {
+        for (int c = 0; c < cols; c++) {
+            vote[c] = (uint16_t)((gx[c] + gy[c]) >> shift);
+        }
+    }
+
+    for (int k = 1; 2 * k <= bins; k++) {
+        int16_t bc = bcos[k], bs = bsin[k];
+        for (int c = 0; c < cols; c++) {
+            bin[c] += (int32_t)bc * gy[c] - (int32_t)bs * gx[c] >= mirror[c];
+        }
+    }
+
+    for (int c = 0; c < cols; c++) {
+        bin[c] = mirror[c] ? (uint8_t)(bins - 1 - bin[c]) : bin[c];
+    }
+}
+
+int sobel_hog(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame, int cell, int bins,
+              sobel_norm_t norm, uint32_t *hist) {
+    int grid_rows, grid_cols;
+
+    if (!frame || !hist || bins < 1 || bins > SOBEL_HOG_MAX_BINS || cell > SOBEL_HOG_MAX_CELL
+        || sobel_density_dims(frame->rows, frame->cols, cell, &grid_rows, &grid_cols) != 0) {
+        return 1;
+    }
+
+    sobel_op_stream_t *stream = sobel_op_stream_open_frame(op, blur, frame);
+    if (!stream) {
+        return 1;
+    }
+
+    int cols = frame->cols;
+    int16_t *grad = malloc(2 * (size_t)cols * sizeof(int16_t));
+    uint16_t *vote = malloc((size_t)cols * sizeof(uint16_t));
+    uint8_t *bin = malloc(2 * (size_t)cols);
+
+    if (!grad || !vote || !bin) {
+        free(grad);
+        free(vote);
+        free(bin);
+        sobel_op_stream_close(stream);
+        return 1;
+    }
+
+    // Boundary k at k * 180 / bins degrees
+    int16_t bcos[SOBEL_HOG_MAX_BINS], bsin[SOBEL_HOG_MAX_BINS];
+    for (int k = 0; k < bins; k++) {
+        double a = M_PI * k / bins;
+        bcos[k] = (int16_t)lround(cos(a) * (1 << HOG_Q));
+        bsin[k] = (int16_t)lround(sin(a) * (1 << HOG_Q));
+    }
+
+    int shift = sobel_op_gain_shift(op);
+    memset(hist, 0, (size_t)grid_rows * grid_cols * bins * sizeof(uint32_t));
+
+    for (int r; (r = sobel_op_stream_next(stream, grad, grad + cols)) >= 0;) {
+        bin_row(grad, grad + cols, cols, bins, bcos, bsin, shift, norm, bin, vote);
+
+        uint32_t *h = hist + (size_t)(r / cell) * grid_cols * bins;
+        for (int c0 = 0; c0 < cols; c0 += cell, h += bins) {
+            int c1 = c0 + cell < cols ? c0 + cell : cols;
+            for (int c = c0; c < c1; c++) {
+                h[bin[c]] += vote[c];
+            }
+        }
+    }
+
+    free(grad);
+    free(vote);
+    free(bin);
+    sobel_op_stream_close(stream);
+    return 0;
+}
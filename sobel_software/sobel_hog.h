@@ -0,0 +1,33 @@
+#ifndef SOBEL_HOG_H
+#define SOBEL_HOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sobel_ops.h"
+
+// --- Orientation histograms (HOG-style) ---
+// Gradient rows are streamed from sobel_ops and binned straight into per-cell histograms, so
+// no gradient plane is ever written. The orientation is unsigned (0 to 180 degrees, the angle
+// of (Gx, Gy) with Gy pointing down the frame) and is binned without atan2: each bin boundary
+// is a Q14 unit vector, and a pixel's bin is the number of boundaries its gradient lies past,
+// found with one integer cross product per boundary. Votes are hard-assigned to one bin and
+// one cell (no interpolation).
+
+#define SOBEL_HOG_MAX_BINS  36
+#define SOBEL_HOG_MAX_CELL  1024
+
+/**
+ * Compute per-cell orientation histograms weighted by gradient magnitude
+ * @param op Gradient operator
+ * @param blur Fused Gaussian pre-smoothing (SOBEL_BLUR_NONE, SOBEL_BLUR_3X3 or SOBEL_BLUR_5X5)
+ * @param frame Input frame
+ * @param cell Cell size in pixels, 1 to SOBEL_HOG_MAX_CELL; edge cells are clipped to the frame
+ * @param bins Orientation bins over 180 degrees, 1 to SOBEL_HOG_MAX_BINS; bin k starts at k * 180 / bins
+ * @param norm Magnitude used as the vote (after the operator gain shift, not saturated)
+ * @param hist Histograms, grid rows x grid cols x bins (see sobel_density_dims), overwritten
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_hog(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame, int cell, int bins,
+              sobel_norm_t norm, uint32_t *hist);
+
+#endif // SOBEL_HOG_H
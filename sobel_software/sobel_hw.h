@@ -0,0 +1,48 @@
+#ifndef SOBEL_HW_H
+#define SOBEL_HW_H
+
+#include <stdint.h>
+
+// --- Bit-exact model of the Sobel IP core ---
+//
+// One frame of rows x cols pixels is streamed into the core, which returns (rows-2) x (cols-2)
+// pixels. window_buffer.vhd forms the window from the pixels shifted in *before* the one it
+// accepts, so output (i, j) is the gradient centred at input pixel (i+1, j) of the stream:
+//   - column 0 takes its left neighbours from the last pixel of the previous row (wrap),
+//   - the two rightmost input columns and the top and bottom input rows are never centres,
+//   - output (0, 0) reads one pixel before the frame, which is 0 after the core is enabled.
+// kernel_application.vhd and manhattan_norm.vhd work on 11-bit signed gradients, which hold
+// every Sobel sum of 8-bit pixels exactly, and saturate |Gx| + |Gy| at 255. scaler.vhd is a
+// pass-through as shipped; its optional divide-by-2 / divide-by-4 variants are selectable.
+
+#define SOBEL_HW_SCALE_NONE  0      // scaler.vhd as shipped
+#define SOBEL_HW_SCALE_DIV2  1      // data_reg <= shift_right(s_data, 1)
+#define SOBEL_HW_SCALE_DIV4  2      // data_reg <= shift_right(s_data, 2)
+
+/**
+ * Compute the output stream of the IP core for one frame
+ * @param input Input frame, rows * cols pixels in stream order
+ * @param output Output stream, (rows-2) * (cols-2) pixels
+ * @param rows Frame rows (rows generic of the core)
+ * @param cols Frame columns (columns generic of the core)
+ * @param scale_shift Right shift of scaler.vhd (SOBEL_HW_SCALE_NONE, _DIV2 or _DIV4)
+ * @param threads Worker threads the frame rows are split over (1 = caller only)
+ * @return 0 on success, 1 on invalid arguments
+ */
+int sobel_hw_frame(const uint8_t *input, uint8_t *output, int rows, int cols, int scale_shift, int threads);
+
+/**
+ * Compute output rows [i0, i1) of the IP core stream, for callers that schedule tiles themselves.
+ * The band reads input rows i0 to i1 + 1, one halo row on each side, and nothing else.
+ * @param input Input frame, rows * cols pixels in stream order
+ * @param output Output stream of the whole frame, (rows-2) * (cols-2) pixels
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param scale_shift Right shift of scaler.vhd
+ * @param i0 First output row
+ * @param i1 Output row after the last one, at most rows - 2
+ * @return 0 on success, 1 on invalid arguments
+ */
+int sobel_hw_band(const uint8_t *input, uint8_t *output, int rows, int cols, int scale_shift, int i0, int i1);
+
+#endif // SOBEL_HW_H
@@ -0,0 +1,430 @@
+#include "sobel_io.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+
+// io_uring through its raw system calls, no liburing needed; other systems get the fallback only
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define SOBEL_IO_URING 1
+#else
+#define SOBEL_IO_URING 0
+#endif
+
+#define IO_ALIGN 4096
+
+typedef struct io_request {
+    int fd;
+    int write;
+    uint8_t *buffer;
+    size_t size;
+    size_t done;             // bytes transferred so far
+    int error;
+    void *user;
+    struct io_request *next; // completion queue of the fallback
+} io_request_t;
+
+struct sobel_io {
+    pthread_mutex_t lock;    // pool, submission queue, fallback completions
+    pthread_cond_t ready;    // fallback: a completion was queued
+    uint8_t *pool;
+    size_t buffer_size;
+    int buffers;
+    uint8_t **free_buffers;
+    int free_count;
+    int in_flight;           // submitted and not yet returned by sobel_io_wait
+    io_request_t *head;      // fallback completions, oldest first
+    io_request_t *tail;
+
+    int ring;                // io_uring fd, -1 for the fallback
+    int fixed;               // pool registered as fixed buffers
+#if SOBEL_IO_URING
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_map, *cq_map;
+    size_t sq_map_size, cq_map_size, sqes_size;
+#endif
+};
+
+// --- io_uring ---
+
+#if SOBEL_IO_URING
+
+static int uring_enter(int ring, unsigned submit, unsigned wait, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, ring, submit, wait, flags, NULL, 0);
+}
+
+static void uring_unmap(sobel_io_t *io) {
+    if (io->sqes) munmap(io->sqes, io->sqes_size);
+    if (io->cq_map && io->cq_map != io->sq_map) munmap(io->cq_map, io->cq_map_size);
+    if (io->sq_map) munmap(io->sq_map, io->sq_map_size);
+    close(io->ring);
+    io->ring = -1;
+}
+
+static int uring_init(sobel_io_t *io) {
+    struct io_uring_params p;
+    unsigned entries = 1;
+    while (entries < (unsigned)io->buffers && entries < 4096) entries <<= 1;
+
+    memset(&p, 0, sizeof(p));
+    io->ring = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (io->ring < 0) {
+        io->ring = -1;
+        return 1;
+    }
+
+    io->sq_map_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    io->cq_map_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        io->sq_map_size = io->cq_map_size = io->sq_map_size > io->cq_map_size ? io->sq_map_size : io->cq_map_size;
+    }
+    io->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+
+    io->sq_map = mmap(NULL, io->sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, io->ring, IORING_OFF_SQ_RING);
+    io->cq_map = (p.features & IORING_FEAT_SINGLE_MMAP) ? io->sq_map
+               : mmap(NULL, io->cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, io->ring, IORING_OFF_CQ_RING);
+    io->sqes = mmap(NULL, io->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, io->ring, IORING_OFF_SQES);
+
+    if (io->sq_map == MAP_FAILED || io->cq_map == MAP_FAILED || io->sqes == MAP_FAILED) {
+        if (io->sq_map == MAP_FAILED) io->sq_map = NULL;
+        if (io->cq_map == MAP_FAILED) io->cq_map = NULL;
+        if (io->sqes == MAP_FAILED) io->sqes = NULL;
+        uring_unmap(io);
+        return 1;
+    }
+
+    uint8_t *sq = io->sq_map, *cq = io->cq_map;
+    io->sq_head = (unsigned *)(sq + p.sq_off.head);
+    io->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+    io->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+    io->sq_array = (unsigned *)(sq + p.sq_off.array);
+    io->cq_head = (unsigned *)(cq + p.cq_off.head);
+    io->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+    io->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+    io->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    // Fixed buffers spare the kernel a page walk per operation; without them (RLIMIT_MEMLOCK)
+    // plain reads and writes are used
+    struct iovec *iov = malloc(io->buffers * sizeof(struct iovec));
+    if (iov) {
+        for (int b = 0; b < io->buffers; b++) {
+            iov[b].iov_base = io->pool + (size_t)b * io->buffer_size;
+            iov[b].iov_len = io->buffer_size;
+        }
+        io->fixed = syscall(__NR_io_uring_register, io->ring, IORING_REGISTER_BUFFERS, iov, io->buffers) == 0;
+        free(iov);
+    }
+    return 0;
+}
+
+// Queue the rest of a request; the caller holds the lock
+static int uring_queue(sobel_io_t *io, io_request_t *req) {
+    unsigned tail = *io->sq_tail;
+    unsigned index = tail & *io->sq_mask;
+    struct io_uring_sqe *sqe = &io->sqes[index];
+    size_t left = req->size - req->done;
+    int fixed = io->fixed && req->buffer >= io->pool && req->buffer < io->pool + (size_t)io->buffers * io->buffer_size;
+
+    if (tail - __atomic_load_n(io->sq_head, __ATOMIC_ACQUIRE) > *io->sq_mask) {
+        return EBUSY;
+    }
+
+    memset(sqe, 0, sizeof(*sqe));
+    if (req->write) {
+        sqe->opcode = fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    } else {
+        sqe->opcode = fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    }
+    sqe->fd = req->fd;
+    sqe->off = req->done;
+    sqe->addr = (uintptr_t)(req->buffer + req->done);
+    sqe->len = (unsigned)(left < (1u << 30) ? left : (1u << 30));
+    sqe->buf_index = fixed ? (uint16_t)((req->buffer - io->pool) / io->buffer_size) : 0;
+    sqe->user_data = (uintptr_t)req;
+
+    io->sq_array[index] = index;
+    __atomic_store_n(io->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+    // Submits everything still in the queue, including entries a failed call left behind
+    unsigned pending = tail + 1 - __atomic_load_n(io->sq_head, __ATOMIC_ACQUIRE);
+    if (uring_enter(io->ring, pending, 0, 0) < 0 && errno != EAGAIN && errno != EBUSY && errno != EINTR) {
+        return errno;
+    }
+    return 0;
+}
+
+// Post a no-op so a waiter blocked in the ring looks at the fallback queue; the caller holds the lock
+static void uring_wake(sobel_io_t *io) {
+    unsigned tail = *io->sq_tail;
+    unsigned index = tail & *io->sq_mask;
+
+    if (tail - __atomic_load_n(io->sq_head, __ATOMIC_ACQUIRE) > *io->sq_mask) {
+        return;
+    }
+    memset(&io->sqes[index], 0, sizeof(io->sqes[index]));
+    io->sqes[index].opcode = IORING_OP_NOP;
+    io->sq_array[index] = index;
+    __atomic_store_n(io->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    uring_enter(io->ring, tail + 1 - __atomic_load_n(io->sq_head, __ATOMIC_ACQUIRE), 0, 0);
+}
+
+// Reap one completion: a finished request, or NULL for a wake-up
+static int uring_reap(sobel_io_t *io, io_request_t **done) {
+    for (;;) {
+        unsigned head = *io->cq_head;
+
+        if (head == __atomic_load_n(io->cq_tail, __ATOMIC_ACQUIRE)) {
+            if (uring_enter(io->ring, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                return 1;
+            }
+            continue;
+        }
+
+        struct io_uring_cqe *cqe = &io->cqes[head & *io->cq_mask];
+        io_request_t *req = (io_request_t *)(uintptr_t)cqe->user_data;
+        int res = cqe->res;
+        __atomic_store_n(io->cq_head, head + 1, __ATOMIC_RELEASE);
+
+        *done = req;
+        if (!req) {
+            return 0;
+        }
+        if (res < 0) {
+            req->error = -res;
+            return 0;
+        }
+
+        // Short transfers continue where they stopped; end of file before size is an error
+        req->done += (size_t)res;
+        if (req->done < req->size && res > 0) {
+            pthread_mutex_lock(&io->lock);
+            req->error = uring_queue(io, req);
+            pthread_mutex_unlock(&io->lock);
+            if (!req->error) continue;
+        } else if (req->done < req->size) {
+            req->error = EIO;
+        }
+        return 0;
+    }
+}
+
+#endif // SOBEL_IO_URING
+
+// --- Fallback ---
+
+static int blocking_transfer(io_request_t *req) {
+    while (req->done < req->size) {
+        ssize_t n = req->write ? pwrite(req->fd, req->buffer + req->done, req->size - req->done, (off_t)req->done)
+                               : pread(req->fd, req->buffer + req->done, req->size - req->done, (off_t)req->done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return n < 0 ? errno : EIO;
+        req->done += (size_t)n;
+    }
+    return 0;
+}
+
+// --- Engine ---
+
+sobel_io_t *sobel_io_open(int buffers, size_t buffer_size, int use_uring) {
+    if (buffers < 1 || buffer_size < 1) {
+        return NULL;
+    }
+
+    sobel_io_t *io = calloc(1, sizeof(*io));
+    if (!io) {
+        return NULL;
+    }
+
+    io->ring = -1;
+    io->buffers = buffers;
+    io->buffer_size = (buffer_size + IO_ALIGN - 1) / IO_ALIGN * IO_ALIGN;
+    io->free_buffers = malloc(buffers * sizeof(uint8_t *));
+    if (!io->free_buffers || posix_memalign((void **)&io->pool, IO_ALIGN, (size_t)buffers * io->buffer_size) != 0) {
+        free(io->free_buffers);
+        free(io);
+        return NULL;
+    }
+
+    for (int b = 0; b < buffers; b++) {
+        io->free_buffers[io->free_count++] = io->pool + (size_t)(buffers - 1 - b) * io->buffer_size;
+    }
+    pthread_mutex_init(&io->lock, NULL);
+    pthread_cond_init(&io->ready, NULL);
+
+#if SOBEL_IO_URING
+    if (use_uring) {
+        uring_init(io);
+    }
+#else
+    (void)use_uring;
+#endif
+    return io;
+}
+
+int sobel_io_uring(const sobel_io_t *io) {
+    return io->ring >= 0;
+}
+
+uint8_t *sobel_io_get_buffer(sobel_io_t *io) {
+    pthread_mutex_lock(&io->lock);
+    uint8_t *buffer = io->free_count ? io->free_buffers[--io->free_count] : NULL;
+    pthread_mutex_unlock(&io->lock);
+    return buffer;
+}
+
+void sobel_io_put_buffer(sobel_io_t *io, uint8_t *buffer) {
+    pthread_mutex_lock(&io->lock);
+    io->free_buffers[io->free_count++] = buffer;
+    pthread_mutex_unlock(&io->lock);
+}
+
+// Queue a request that is already done; the caller holds the lock
+static void queue_done(sobel_io_t *io, io_request_t *req) {
+    if (io->tail) {
+        io->tail->next = req;
+    } else {
+        io->head = req;
+    }
+    io->tail = req;
+    pthread_cond_signal(&io->ready);
+#if SOBEL_IO_URING
+    if (io->ring >= 0) {
+        uring_wake(io);
+    }
+#endif
+}
+
+static int submit(sobel_io_t *io, const char *path, uint8_t *buffer, size_t size, void *user, int write) {
+    io_request_t *req = calloc(1, sizeof(*req));
+    if (!req) {
+        errno = ENOMEM;
+        return 1;
+    }
+
+    req->fd = write ? open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) : open(path, O_RDONLY | O_CLOEXEC);
+    if (req->fd < 0) {
+        free(req);
+        return 1;
+    }
+    req->write = write;
+    req->buffer = buffer;
+    req->size = size;
+    req->user = user;
+
+    // Without a ring the transfer happens here, outside the lock
+    if (io->ring < 0) {
+        req->error = blocking_transfer(req);
+    }
+
+    pthread_mutex_lock(&io->lock);
+    io->in_flight++;
+#if SOBEL_IO_URING
+    if (io->ring >= 0 && size) {
+        req->error = uring_queue(io, req);
+        if (!req->error) {
+            pthread_mutex_unlock(&io->lock);
+            return 0;
+        }
+    }
+#endif
+    // Fallback, empty files or an operation the ring refused: reported by sobel_io_wait as usual
+    queue_done(io, req);
+    pthread_mutex_unlock(&io->lock);
+    return 0;
+}
+
+int sobel_io_read(sobel_io_t *io, const char *path, uint8_t *buffer, size_t size, void *user) {
+    return submit(io, path, buffer, size, user, 0);
+}
+
+int sobel_io_write(sobel_io_t *io, const char *path, uint8_t *buffer, size_t size, void *user) {
+    return submit(io, path, buffer, size, user, 1);
+}
+
+int sobel_io_post(sobel_io_t *io, void *user, int error) {
+    io_request_t *req = calloc(1, sizeof(*req));
+    if (!req) {
+        return 1;
+    }
+
+    req->fd = -1;
+    req->user = user;
+    req->error = error;
+
+    pthread_mutex_lock(&io->lock);
+    io->in_flight++;
+    queue_done(io, req);
+    pthread_mutex_unlock(&io->lock);
+    return 0;
+}
+
+int sobel_io_wait(sobel_io_t *io, sobel_io_event_t *event) {
+    io_request_t *req = NULL;
+
+    for (;;) {
+        pthread_mutex_lock(&io->lock);
+        if (io->head) {
+            req = io->head;
+            io->head = req->next;
+            if (!io->head) io->tail = NULL;
+        } else if (io->ring < 0) {
+            pthread_cond_wait(&io->ready, &io->lock);
+        }
+        pthread_mutex_unlock(&io->lock);
+
+        if (req) break;
+#if SOBEL_IO_URING
+        if (io->ring >= 0) {
+            if (uring_reap(io, &req) != 0) return 1;
+            if (req) break;
+        }
+#endif
+    }
+
+    int error = req->error;
+    if (req->fd >= 0 && close(req->fd) != 0 && !error && req->write) {
+        error = errno;
+    }
+
+    event->user = req->user;
+    event->buffer = req->buffer;
+    event->size = req->size;
+    event->write = req->write;
+    event->error = error;
+    free(req);
+
+    pthread_mutex_lock(&io->lock);
+    io->in_flight--;
+    pthread_mutex_unlock(&io->lock);
+    return 0;
+}
+
+void sobel_io_close(sobel_io_t *io) {
+    if (!io) {
+        return;
+    }
+
+    sobel_io_event_t event;
+    while (io->in_flight > 0 && sobel_io_wait(io, &event) == 0) {
+    }
+
+#if SOBEL_IO_URING
+    if (io->ring >= 0) {
+        uring_unmap(io);
+    }
+#endif
+    pthread_cond_destroy(&io->ready);
+    pthread_mutex_destroy(&io->lock);
+    free(io->pool);
+    free(io->free_buffers);
+    free(io);
+}
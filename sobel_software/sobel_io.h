@@ -0,0 +1,101 @@
+#ifndef SOBEL_IO_H
+#define SOBEL_IO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Asynchronous file I/O ---
+// Whole-file reads and writes kept in flight together, for batch runs on fast storage. With
+// io_uring the buffers come from one preallocated pool registered with the kernel (fixed
+// buffers), many operations are queued at once and completions are reaped by a single thread.
+// Where io_uring is missing or refused (old kernels, seccomp), every call falls back to
+// blocking open/read/write and its completion is queued the same way, so callers run one code
+// path. Submissions may come from any thread; sobel_io_wait must be called from one thread only.
+
+typedef struct sobel_io sobel_io_t;
+
+typedef struct {
+    void *user;             // as passed at submission
+    uint8_t *buffer;
+    size_t size;
+    int write;              // 1 for a completed write, 0 for a read
+    int error;              // 0, or an errno value
+} sobel_io_event_t;
+
+/**
+ * Create an I/O engine and its buffer pool
+ * @param buffers Number of pool buffers, also the most operations in flight
+ * @param buffer_size Bytes per buffer
+ * @param use_uring 1 to use io_uring when the kernel allows it, 0 to force blocking I/O
+ * @return The engine, or NULL on allocation failure
+ */
+sobel_io_t *sobel_io_open(int buffers, size_t buffer_size, int use_uring);
+
+/**
+ * Whether the engine runs on io_uring
+ * @param io Engine
+ * @return 1 for io_uring, 0 for the blocking fallback
+ */
+int sobel_io_uring(const sobel_io_t *io);
+
+/**
+ * Take a buffer from the pool
+ * @param io Engine
+ * @return A buffer of buffer_size bytes, or NULL if all are in use
+ */
+uint8_t *sobel_io_get_buffer(sobel_io_t *io);
+
+/**
+ * Return a buffer to the pool
+ * @param io Engine
+ * @param buffer Buffer from sobel_io_get_buffer
+ */
+void sobel_io_put_buffer(sobel_io_t *io, uint8_t *buffer);
+
+/**
+ * Queue a read of the first size bytes of a file; a shorter file completes with EIO
+ * @param io Engine
+ * @param path File to read
+ * @param buffer Destination, a pool buffer for fixed-buffer I/O
+ * @param size Bytes to read
+ * @param user Returned with the completion
+ * @return 0 if queued, 1 if the file cannot be opened (errno is set)
+ */
+int sobel_io_read(sobel_io_t *io, const char *path, uint8_t *buffer, size_t size, void *user);
+
+/**
+ * Queue the creation of a file holding size bytes
+ * @param io Engine
+ * @param path File to write, truncated
+ * @param buffer Source, must stay untouched until the completion
+ * @param size Bytes to write
+ * @param user Returned with the completion
+ * @return 0 if queued, 1 if the file cannot be created (errno is set)
+ */
+int sobel_io_write(sobel_io_t *io, const char *path, uint8_t *buffer, size_t size, void *user);
+
+/**
+ * Queue a completion without any I/O, to hand a result to the waiting thread through the same path
+ * @param io Engine
+ * @param user Returned with the completion
+ * @param error Returned with the completion
+ * @return 0 if queued, 1 on allocation failure
+ */
+int sobel_io_post(sobel_io_t *io, void *user, int error);
+
+/**
+ * Wait for the next completed operation. Blocks until one arrives, including operations that
+ * other threads have yet to submit, so only call it while some are expected.
+ * @param io Engine
+ * @param event Completion
+ * @return 0 on success, 1 if the engine failed
+ */
+int sobel_io_wait(sobel_io_t *io, sobel_io_event_t *event);
+
+/**
+ * Release the engine; operations still in flight are waited for and dropped
+ * @param io Engine, may be NULL
+ */
+void sobel_io_close(sobel_io_t *io);
+
+#endif // SOBEL_IO_H
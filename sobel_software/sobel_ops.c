@@ -0,0 +1,769 @@
+#include "sobel_ops.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define OP_MAX_RADIUS 2
+#define OP_LIST(...) { __VA_ARGS__ }
+
+typedef struct {
+    int16_t *vs;             // vertical smooth, cols + 2 * radius, borders replicated
+    int16_t *vd;             // vertical diff, same layout
+    int16_t *gx;             // one row of gradients for the magnitude path
+    int16_t *gy;
+    uint16_t *bv;            // vertical blur sums, cols + 2 * blur radius
+    uint8_t *ring;           // blurred rows, 2 * OP_MAX_RADIUS + 1 of them
+} op_lines_t;
+
+typedef void (*op_row_fn)(const uint8_t *const *p, int cols, op_lines_t *lines, int16_t *gx, int16_t *gy);
+
+typedef struct {
+    int32_t *vs;             // as op_lines_t, 32-bit for high bit depth input
+    int32_t *vd;
+    int32_t *gx;
+    int32_t *gy;
+} op_lines16_t;
+
+typedef void (*op_row16_fn)(const uint16_t *const *p, int cols, op_lines16_t *lines);
+
+typedef struct {
+    const char *name;
+    int radius;
+    int gain_shift;
+    op_row_fn row;
+    op_row16_fn row16;
+} op_info_t;
+
+typedef void (*blur_row_fn)(const uint8_t *const *p, int cols, uint16_t *line, uint8_t *out);
+
+typedef struct {
+    int radius;
+    blur_row_fn row;
+} blur_info_t;
+
+// --- Generic row kernel ---
+// Always inlined into each operator below with constant coefficient tables, so every
+// instantiation is unrolled over the taps, drops zero taps, and vectorises over columns.
+// p[k] is input row r + k - radius, already clamped to the frame.
+static inline __attribute__((always_inline))
+void op_row(const int16_t *smooth, const int16_t *diff, int radius, const uint8_t *const *p, int cols,
+            op_lines_t *lines, int16_t *restrict gx, int16_t *restrict gy) {
+    int16_t *restrict vs = lines->vs;
+    int16_t *restrict vd = lines->vd;
+
+    // Vertical pass
+    for (int c = 0; c < cols; c++) {
+        int a = 0, b = 0;
+        for (int k = 0; k <= 2 * radius; k++) {
+            a += smooth[k] * p[k][c];
+            b += diff[k] * p[k][c];
+        }
+        vs[radius + c] = (int16_t)a;
+        vd[radius + c] = (int16_t)b;
+    }
+
+    // Clamped columns
+    for (int k = 0; k < radius; k++) {
+        vs[k] = vs[radius];
+        vd[k] = vd[radius];
+        vs[radius + cols + k] = vs[radius + cols - 1];
+        vd[radius + cols + k] = vd[radius + cols - 1];
+    }
+
+    // Horizontal pass
+    for (int c = 0; c < cols; c++) {
+        int a = 0, b = 0;
+        for (int k = 0; k <= 2 * radius; k++) {
+            a += diff[k] * vs[c + k];
+            b += smooth[k] * vd[c + k];
+        }
+        gx[c] = (int16_t)a;
+        gy[c] = (int16_t)b;
+    }
+}
+
+// Same kernel for uint16 samples of up to 16 bits. The worst case, 5x5 Sobel on 16-bit input,
+// reaches 16 * 16 * 65535 before the gain shift, so the lines are int32 and the loops vectorise
+// over 32-bit lanes.
+static inline __attribute__((always_inline))
+void op_row16(const int16_t *smooth, const int16_t *diff, int radius, const uint16_t *const *p, int cols,
+              op_lines16_t *lines) {
+    int32_t *restrict vs = lines->vs;
+    int32_t *restrict vd = lines->vd;
+    int32_t *restrict gx = lines->gx;
+    int32_t *restrict gy = lines->gy;
+
+    for (int c = 0; c < cols; c++) {
+        int32_t a = 0, b = 0;
+        for (int k = 0; k <= 2 * radius; k++) {
+            a += smooth[k] * (int32_t)p[k][c];
+            b += diff[k] * (int32_t)p[k][c];
+        }
+        vs[radius + c] = a;
+        vd[radius + c] = b;
+    }
+
+    for (int k = 0; k < radius; k++) {
+        vs[k] = vs[radius];
+        vd[k] = vd[radius];
+        vs[radius + cols + k] = vs[radius + cols - 1];
+        vd[radius + cols + k] = vd[radius + cols - 1];
+    }
+
+    for (int c = 0; c < cols; c++) {
+        int32_t a = 0, b = 0;
+        for (int k = 0; k <= 2 * radius; k++) {
+            a += diff[k] * vs[c + k];
+            b += smooth[k] * vd[c + k];
+        }
+        gx[c] = a;
+        gy[c] = b;
+    }
+}
+
+#define SOBEL_OP_DEFINE(NAME, RADIUS, SMOOTH, DIFF)                                              \
+    static const int16_t NAME##_smooth[2 * (RADIUS) + 1] = OP_LIST SMOOTH;                        \
+    static const int16_t NAME##_diff[2 * (RADIUS) + 1] = OP_LIST DIFF;                            \
+    static void NAME##_row(const uint8_t *const *p, int cols, op_lines_t *lines,                 \
+                           int16_t *gx, int16_t *gy) {                                            \
+        op_row(NAME##_smooth, NAME##_diff, RADIUS, p, cols, lines, gx, gy);                       \
+    }                                                                                             \
+    static void NAME##_row16(const uint16_t *const *p, int cols, op_lines16_t *lines) {          \
+        op_row16(NAME##_smooth, NAME##_diff, RADIUS, p, cols, lines);                             \
+    }
+
+SOBEL_OP_DEFINE(sobel,   1, (1, 2, 1),       (-1, 0, 1))
+SOBEL_OP_DEFINE(scharr,  1, (3, 10, 3),      (-1, 0, 1))
+SOBEL_OP_DEFINE(prewitt, 1, (1, 1, 1),       (-1, 0, 1))
+SOBEL_OP_DEFINE(sobel5,  2, (1, 4, 6, 4, 1), (-1, -2, 0, 2, 1))
+
+static const op_info_t op_table[SOBEL_OP_COUNT] = {
+    [SOBEL_OP_SOBEL]   = { "sobel",   1, 0, sobel_row,   sobel_row16 },
+    [SOBEL_OP_SCHARR]  = { "scharr",  1, 2, scharr_row,  scharr_row16 },
+    [SOBEL_OP_PREWITT] = { "prewitt", 1, 0, prewitt_row, prewitt_row16 },
+    [SOBEL_OP_SOBEL5]  = { "sobel5",  2, 3, sobel5_row,  sobel5_row16 },
+};
+
+// --- Gaussian pre-smoothing ---
+// Same scheme as op_row: the binomial taps are constants of each instantiation. The sum is
+// rounded once at the end, so the result equals the 2-D kernel applied directly.
+static inline __attribute__((always_inline))
+void blur_row(const uint16_t *taps, int radius, int shift, const uint8_t *const *p, int cols,
+              uint16_t *restrict line, uint8_t *restrict out) {
+    for (int c = 0; c < cols; c++) {
+        int a = 0;
+        for (int k = 0; k <= 2 * radius; k++) {
+            a += taps[k] * p[k][c];
+        }
+        line[radius + c] = (uint16_t)a;
+    }
+
+    for (int k = 0; k < radius; k++) {
+        line[k] = line[radius];
+        line[radius + cols + k] = line[radius + cols - 1];
+    }
+
+    for (int c = 0; c < cols; c++) {
+        int a = 1 << (shift - 1);
+        for (int k = 0; k <= 2 * radius; k++) {
+            a += taps[k] * line[c + k];
+        }
+        out[c] = (uint8_t)(a >> shift);
+    }
+}
+
+#define SOBEL_BLUR_DEFINE(NAME, RADIUS, SHIFT, TAPS)                                              \
+    static const uint16_t NAME##_taps[2 * (RADIUS) + 1] = OP_LIST TAPS;                           \
+    static void NAME##_row(const uint8_t *const *p, int cols, uint16_t *line, uint8_t *out) {     \
+        blur_row(NAME##_taps, RADIUS, SHIFT, p, cols, line, out);                                 \
+    }
+
+SOBEL_BLUR_DEFINE(gauss3, 1, 4, (1, 2, 1))
+SOBEL_BLUR_DEFINE(gauss5, 2, 8, (1, 4, 6, 4, 1))
+
+static const blur_info_t *blur_info(sobel_blur_t blur) {
+    static const blur_info_t gauss3 = { 1, gauss3_row };
+    static const blur_info_t gauss5 = { 2, gauss5_row };
+
+    switch (blur) {
+        case SOBEL_BLUR_3X3: return &gauss3;
+        case SOBEL_BLUR_5X5: return &gauss5;
+        default:             return NULL;
+    }
+}
+
+// --- Selection ---
+
+sobel_op_t sobel_op_from_name(const char *name) {
+    for (int op = 0; op < SOBEL_OP_COUNT; op++) {
+        if (name && strcmp(name, op_table[op].name) == 0) {
+            return (sobel_op_t)op;
+        }
+    }
+    return SOBEL_OP_COUNT;
+}
+
+const char *sobel_op_name(sobel_op_t op) {
+    return op >= 0 && op < SOBEL_OP_COUNT ? op_table[op].name : "unknown";
+}
+
+int sobel_op_gain_shift(sobel_op_t op) {
+    return op >= 0 && op < SOBEL_OP_COUNT ? op_table[op].gain_shift : 0;
+}
+
+// --- Frames ---
+
+// Row pointers for rows r - radius .. r + radius, clamped to the frame
+static void frame_rows(const uint8_t *input, int rows, size_t stride, int r, int radius, const uint8_t **p) {
+    for (int k = 0; k <= 2 * radius; k++) {
+        int y = r + k - radius;
+        y = y < 0 ? 0 : (y >= rows ? rows - 1 : y);
+        p[k] = input + (size_t)y * stride;
+    }
+}
+
+static int lines_alloc(op_lines_t *lines, int cols, const blur_info_t *blur) {
+    size_t n = (size_t)cols + 2 * OP_MAX_RADIUS;
+    size_t ring = blur ? (2 * OP_MAX_RADIUS + 1) * (size_t)cols : 0;
+    int16_t *mem = malloc(4 * n * sizeof(int16_t) + (blur ? n * sizeof(uint16_t) : 0) + ring);
+
+    if (!mem) return 1;
+    lines->vs = mem;
+    lines->vd = mem + n;
+    lines->gx = mem + 2 * n;
+    lines->gy = mem + 3 * n;
+    lines->bv = blur ? (uint16_t *)(mem + 4 * n) : NULL;
+    lines->ring = blur ? (uint8_t *)(lines->bv + n) : NULL;
+    return 0;
+}
+
+// --- Luma ---
+// BT.601 full-range luma, Y = (77 R + 150 G + 29 B + 128) >> 8, inlined per channel order so
+// the interleaved loads are constant offsets and the loop vectorises
+static inline __attribute__((always_inline))
+void luma_row(const uint8_t *restrict src, int cols, int ri, int bi, uint8_t *restrict out) {
+    for (int c = 0; c < cols; c++) {
+        const uint8_t *px = src + 3 * c;
+        out[c] = (uint8_t)((77 * px[ri] + 150 * px[1] + 29 * px[bi] + 128) >> 8);
+    }
+}
+
+static void rgb_row(const uint8_t *src, int cols, uint8_t *out) { luma_row(src, cols, 0, 2, out); }
+static void bgr_row(const uint8_t *src, int cols, uint8_t *out) { luma_row(src, cols, 2, 0, out); }
+
+// In-place grey frames go through the same ring: each row is saved just before the output
+// can overwrite it
+static void copy_row(const uint8_t *src, int cols, uint8_t *out) { memcpy(out, src, (size_t)cols); }
+
+size_t sobel_frame_bytes(sobel_pixfmt_t format, int rows, int cols) {
+    size_t pixels = (size_t)rows * cols;
+
+    switch (format) {
+        case SOBEL_PIX_GRAY8: return pixels;
+        case SOBEL_PIX_RGB24:
+        case SOBEL_PIX_BGR24: return 3 * pixels;
+        case SOBEL_PIX_I420:
+        case SOBEL_PIX_NV12:  return pixels + 2 * ((size_t)((rows + 1) / 2) * ((cols + 1) / 2));
+        default:              return 0;
+    }
+}
+
+sobel_pixfmt_t sobel_pixfmt_from_name(const char *name) {
+    static const char *names[] = { "gray8", "rgb24", "bgr24", "i420", "nv12" };
+
+    for (int f = 0; name && f < (int)(sizeof(names) / sizeof(names[0])); f++) {
+        if (strcmp(name, names[f]) == 0) {
+            return (sobel_pixfmt_t)f;
+        }
+    }
+    return SOBEL_PIX_COUNT;
+}
+
+struct sobel_op_stream {
+    const op_info_t *info;
+    const blur_info_t *blur;
+    const uint8_t *input;
+    int rows;
+    int cols;
+    size_t stride;
+    int next;                    // next output row
+    int blurred;                 // blurred rows produced so far
+    op_lines_t lines;
+    void (*convert)(const uint8_t *src, int cols, uint8_t *out);
+    int converted;               // luma rows produced so far
+    int luma_slots;              // rows in the luma ring, 2 * radius + 1 of the stage reading it
+    uint8_t *luma;               // converted rows, colour or in-place input only
+};
+
+// Luma rows r - radius .. r + radius, clamped. Grey and YUV frames are read in place (the
+// Y plane is the luma); colour rows are converted just ahead of use into a small ring.
+static void luma_rows(sobel_op_stream_t *s, int r, int radius, const uint8_t **p) {
+    if (!s->luma) {
+        frame_rows(s->input, s->rows, s->stride, r, radius, p);
+        return;
+    }
+
+    int need = r + radius < s->rows ? r + radius + 1 : s->rows;
+    for (; s->converted < need; s->converted++) {
+        s->convert(s->input + (size_t)s->converted * s->stride, s->cols,
+                   s->luma + (size_t)(s->converted % s->luma_slots) * s->cols);
+    }
+
+    for (int k = 0; k <= 2 * radius; k++) {
+        int y = r + k - radius;
+        y = y < 0 ? 0 : (y >= s->rows ? s->rows - 1 : y);
+        p[k] = s->luma + (size_t)(y % s->luma_slots) * s->cols;
+    }
+}
+
+static sobel_op_stream_t *stream_open(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame, int in_place) {
+    const blur_info_t *bi = blur_info(blur);
+
+    if (op < 0 || op >= SOBEL_OP_COUNT || (blur != SOBEL_BLUR_NONE && !bi) || !frame || !frame->data
+        || frame->rows < 1 || frame->cols < 1 || frame->format < 0 || frame->format >= SOBEL_PIX_COUNT) {
+        return NULL;
+    }
+
+    sobel_op_stream_t *s = calloc(1, sizeof(*s));
+    if (!s || lines_alloc(&s->lines, frame->cols, bi) != 0) {
+        free(s);
+        return NULL;
+    }
+
+    s->info = &op_table[op];
+    s->blur = bi;
+    s->input = frame->data;
+    s->rows = frame->rows;
+    s->cols = frame->cols;
+    s->stride = frame->stride;
+
+    if (in_place || frame->format == SOBEL_PIX_RGB24 || frame->format == SOBEL_PIX_BGR24) {
+        s->convert = in_place ? copy_row : (frame->format == SOBEL_PIX_RGB24 ? rgb_row : bgr_row);
+        s->luma_slots = 2 * (bi ? bi->radius : s->info->radius) + 1;
+        s->luma = malloc((size_t)s->luma_slots * s->cols);
+        if (!s->luma) {
+            sobel_op_stream_close(s);
+            return NULL;
+        }
+    }
+    return s;
+}
+
+sobel_op_stream_t *sobel_op_stream_open_frame(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame) {
+    return stream_open(op, blur, frame, 0);
+}
+
+sobel_op_stream_t *sobel_op_stream_open(sobel_op_t op, sobel_blur_t blur, const uint8_t *input,
+                                        int rows, int cols, size_t in_stride) {
+    sobel_frame_t frame = { input, rows, cols, in_stride, SOBEL_PIX_GRAY8 };
+    return sobel_op_stream_open_frame(op, blur, &frame);
+}
+
+// With a blur, blurred rows are produced just ahead of the gradient into a ring of
+// 2 * radius + 1 rows, so the blurred frame never exists in memory
+int sobel_op_stream_next(sobel_op_stream_t *s, int16_t *gx, int16_t *gy) {
+    if (s->next >= s->rows) {
+        return -1;
+    }
+
+    const uint8_t *p[2 * OP_MAX_RADIUS + 1];
+    int r = s->next++, rows = s->rows, cols = s->cols;
+    int radius = s->info->radius, slots = 2 * radius + 1;
+
+    if (s->blur) {
+        int need = r + radius < rows ? r + radius + 1 : rows;
+        for (; s->blurred < need; s->blurred++) {
+            const uint8_t *q[2 * OP_MAX_RADIUS + 1];
+            luma_rows(s, s->blurred, s->blur->radius, q);
+            s->blur->row(q, cols, s->lines.bv, s->lines.ring + (size_t)(s->blurred % slots) * cols);
+        }
+        for (int k = 0; k < slots; k++) {
+            int y = r + k - radius;
+            y = y < 0 ? 0 : (y >= rows ? rows - 1 : y);
+            p[k] = s->lines.ring + (size_t)(y % slots) * cols;
+        }
+    } else {
+        luma_rows(s, r, radius, p);
+    }
+
+    s->info->row(p, cols, &s->lines, gx ? gx : s->lines.gx, gy ? gy : s->lines.gy);
+    return r;
+}
+
+void sobel_op_stream_close(sobel_op_stream_t *s) {
+    if (s) {
+        free(s->lines.vs);
+        free(s->luma);
+        free(s);
+    }
+}
+
+// Gain-shifted magnitude of a gradient row, saturated at 255
+static void magnitude_row(const int16_t *gx, const int16_t *gy, int cols, int shift, sobel_norm_t norm,
+                          uint8_t *out) {
+    if (norm == SOBEL_NORM_EUCLIDEAN) {
+        for (int c = 0; c < cols; c++) {
+            int sx = gx[c], sy = gy[c];
+            int magnitude = (int)(sqrt(sx * sx + sy * sy) + 0.5) >> shift;
+            out[c] = magnitude > 255 ? 255 : magnitude;
+        }
+    } else {
+        for (int c = 0; c < cols; c++) {
+            int sx = gx[c], sy = gy[c];
+            int magnitude = ((sx < 0 ? -sx : sx) + (sy < 0 ? -sy : sy)) >> shift;
+            out[c] = magnitude > 255 ? 255 : magnitude;
+        }
+    }
+}
+
+// Add one magnitude row to the density grid row it falls in
+static void density_row(const uint8_t *mag, int cols, const sobel_density_t *d, uint32_t *sum, uint32_t *count) {
+    for (int c0 = 0, cell = 0; c0 < cols; c0 += d->cell, cell++) {
+        int c1 = c0 + d->cell < cols ? c0 + d->cell : cols;
+        uint32_t s = 0, n = 0;
+        for (int c = c0; c < c1; c++) {
+            s += mag[c];
+            n += mag[c] >= d->threshold;
+        }
+        sum[cell] += s;
+        if (count) count[cell] += n;
+    }
+}
+
+// Gradients go to gx/gy when given, otherwise their magnitude goes to output, to the density
+// grid, or both. Output row r is written only after stream_next(r), which has already saved
+// every input row up to r.
+static int op_frame(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame, int in_place,
+                    uint8_t *output, size_t out_stride, sobel_norm_t norm, const sobel_density_t *density,
+                    int16_t *gx, int16_t *gy, size_t g_stride) {
+    int grid_rows = 0, grid_cols = 0;
+    if (density && (!density->sum || sobel_density_dims(frame ? frame->rows : 0, frame ? frame->cols : 0,
+                                                        density->cell, &grid_rows, &grid_cols) != 0)) {
+        return 1;
+    }
+
+    sobel_op_stream_t *s = stream_open(op, blur, frame, in_place);
+    if (!s) {
+        return 1;
+    }
+
+    // Rows that only feed the density grid go through one scratch row
+    uint8_t *scratch = output || gx ? NULL : malloc(s->cols);
+    if (!output && !gx && !scratch) {
+        sobel_op_stream_close(s);
+        return 1;
+    }
+
+    int rows = s->rows, cols = s->cols;
+    int shift = s->info->gain_shift;
+    int16_t *lgx = s->lines.gx, *lgy = s->lines.gy;
+
+    if (density) {
+        memset(density->sum, 0, (size_t)grid_rows * grid_cols * sizeof(uint32_t));
+        if (density->count) memset(density->count, 0, (size_t)grid_rows * grid_cols * sizeof(uint32_t));
+    }
+
+    for (int r = 0; r < rows; r++) {
+        if (gx) {
+            sobel_op_stream_next(s, gx + (size_t)r * g_stride, gy + (size_t)r * g_stride);
+            continue;
+        }
+
+        uint8_t *out = output ? output + (size_t)r * out_stride : scratch;
+        sobel_op_stream_next(s, NULL, NULL);
+
+        magnitude_row(lgx, lgy, cols, shift, norm, out);
+
+        // The row is still in L1, so the grid costs no second pass over the frame
+        if (density) {
+            size_t cell = (size_t)(r / density->cell) * grid_cols;
+            density_row(out, cols, density, density->sum + cell, density->count ? density->count + cell : NULL);
+        }
+    }
+
+    free(scratch);
+    sobel_op_stream_close(s);
+    return 0;
+}
+
+int sobel_density_dims(int rows, int cols, int cell, int *grid_rows, int *grid_cols) {
+    // Sums of up to cell * cell pixels of 255 must fit in 32 bits
+    if (rows < 1 || cols < 1 || cell < 1 || cell > 4096) {
+        return 1;
+    }
+    *grid_rows = (rows + cell - 1) / cell;
+    *grid_cols = (cols + cell - 1) / cell;
+    return 0;
+}
+
+int sobel_op_density(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame, uint8_t *output,
+                     size_t out_stride, sobel_norm_t norm, const sobel_density_t *density) {
+    return density ? op_frame(op, blur, frame, 0, output, out_stride, norm, density, NULL, NULL, 0) : 1;
+}
+
+int sobel_op_magnitude(sobel_op_t op, const uint8_t *input, int rows, int cols, size_t in_stride,
+                       uint8_t *output, size_t out_stride, sobel_norm_t norm) {
+    sobel_frame_t frame = { input, rows, cols, in_stride, SOBEL_PIX_GRAY8 };
+    return output ? op_frame(op, SOBEL_BLUR_NONE, &frame, 0, output, out_stride, norm, NULL, NULL, NULL, 0) : 1;
+}
+
+int sobel_op_gradients(sobel_op_t op, const uint8_t *input, int rows, int cols, size_t in_stride,
+                       int16_t *gx, int16_t *gy, size_t out_stride) {
+    sobel_frame_t frame = { input, rows, cols, in_stride, SOBEL_PIX_GRAY8 };
+    return gx && gy ? op_frame(op, SOBEL_BLUR_NONE, &frame, 0, NULL, 0, 0, NULL, gx, gy, out_stride) : 1;
+}
+
+int sobel_op_blur_magnitude(sobel_op_t op, sobel_blur_t blur, const uint8_t *input, int rows, int cols,
+                            size_t in_stride, uint8_t *output, size_t out_stride, sobel_norm_t norm) {
+    sobel_frame_t frame = { input, rows, cols, in_stride, SOBEL_PIX_GRAY8 };
+    return output ? op_frame(op, blur, &frame, 0, output, out_stride, norm, NULL, NULL, NULL, 0) : 1;
+}
+
+int sobel_op_frame_magnitude(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame,
+                             uint8_t *output, size_t out_stride, sobel_norm_t norm) {
+    return output ? op_frame(op, blur, frame, 0, output, out_stride, norm, NULL, NULL, NULL, 0) : 1;
+}
+
+int sobel_op_magnitude_inplace(sobel_op_t op, sobel_blur_t blur, uint8_t *image, int rows, int cols,
+                               size_t stride, sobel_norm_t norm) {
+    sobel_frame_t frame = { image, rows, cols, stride, SOBEL_PIX_GRAY8 };
+    return image ? op_frame(op, blur, &frame, 1, image, stride, norm, NULL, NULL, NULL, 0) : 1;
+}
+
+// --- Pyramid ---
+// Level l + 1 is the 2x2 box average of level l, odd edges replicated. Every level sees its last
+// 2 * radius + 1 input rows through a ring of row pointers; pushing a row computes the output
+// rows whose window is complete and, each time a pair of rows is in, pushes their average to
+// the next level. The source is read once and in place, and the coarse inputs exist only as a
+// few lines each.
+
+typedef struct {
+    const op_info_t *info;
+    op_lines_t lines;
+    sobel_norm_t norm;
+    int levels;
+    int slots;
+    uint8_t *half;               // one downsampled row on its way to the next level
+    struct {
+        int rows;
+        int cols;
+        int have;                // input rows pushed
+        int next;                // next output row
+        const uint8_t *rowp[2 * OP_MAX_RADIUS + 1];
+        uint8_t *ring;           // row storage for levels fed by transient rows, NULL for level 0
+        uint8_t *out;
+    } level[SOBEL_PYRAMID_MAX_LEVELS];
+} pyramid_ctx_t;
+
+// Average rows a and b two by two into half
+static void downsample_row(const uint8_t *restrict a, const uint8_t *restrict b, int cols, uint8_t *restrict half) {
+    int pairs = cols / 2;
+
+    for (int c = 0; c < pairs; c++) {
+        half[c] = (uint8_t)((a[2 * c] + a[2 * c + 1] + b[2 * c] + b[2 * c + 1] + 2) >> 2);
+    }
+    if (cols & 1) {
+        half[pairs] = (uint8_t)((2 * a[cols - 1] + 2 * b[cols - 1] + 2) >> 2);
+    }
+}
+
+// Row must stay valid until 2 * radius + 1 more rows are pushed, unless the level has a ring
+static void pyramid_push(pyramid_ctx_t *ctx, int l, const uint8_t *row) {
+    int radius = ctx->info->radius, slots = ctx->slots;
+    int rows = ctx->level[l].rows, cols = ctx->level[l].cols;
+    const uint8_t **rowp = ctx->level[l].rowp;
+    int slot = ctx->level[l].have % slots;
+
+    if (ctx->level[l].ring) {
+        uint8_t *copy = ctx->level[l].ring + (size_t)slot * cols;
+        memcpy(copy, row, (size_t)cols);
+        row = copy;
+    }
+    rowp[slot] = row;
+    int have = ++ctx->level[l].have;
+
+    // Output rows whose 2 * radius + 1 input rows are all in, or all remaining ones at the end
+    for (int r = ctx->level[l].next; r < rows && (r + radius < have || have == rows); r = ++ctx->level[l].next) {
+        const uint8_t *p[2 * OP_MAX_RADIUS + 1];
+        for (int k = 0; k <= 2 * radius; k++) {
+            int y = r + k - radius;
+            y = y < 0 ? 0 : (y >= rows ? rows - 1 : y);
+            p[k] = rowp[y % slots];
+        }
+        ctx->info->row(p, cols, &ctx->lines, ctx->lines.gx, ctx->lines.gy);
+        magnitude_row(ctx->lines.gx, ctx->lines.gy, cols, ctx->info->gain_shift, ctx->norm,
+                      ctx->level[l].out + (size_t)r * cols);
+    }
+
+    if (l + 1 < ctx->levels && (have % 2 == 0 || have == rows)) {
+        downsample_row(rowp[(have - 1 - (have % 2 == 0)) % slots], rowp[(have - 1) % slots], cols, ctx->half);
+        pyramid_push(ctx, l + 1, ctx->half);
+    }
+}
+
+int sobel_pyramid_layout(int rows, int cols, int levels, sobel_pyramid_t *pyramid) {
+    if (!pyramid || rows < 1 || cols < 1 || levels < 1 || levels > SOBEL_PYRAMID_MAX_LEVELS) {
+        return 1;
+    }
+
+    pyramid->levels = levels;
+    pyramid->bytes = 0;
+    for (int l = 0; l < levels; l++) {
+        pyramid->rows[l] = rows;
+        pyramid->cols[l] = cols;
+        pyramid->offset[l] = pyramid->bytes;
+        pyramid->bytes += (size_t)rows * cols;
+        rows = (rows + 1) / 2;
+        cols = (cols + 1) / 2;
+    }
+    return 0;
+}
+
+int sobel_op_pyramid(sobel_op_t op, const sobel_frame_t *frame, sobel_norm_t norm,
+                     const sobel_pyramid_t *pyramid, uint8_t *arena) {
+    if (!pyramid || !arena || pyramid->levels < 1 || pyramid->levels > SOBEL_PYRAMID_MAX_LEVELS || !frame
+        || frame->rows != pyramid->rows[0] || frame->cols != pyramid->cols[0]) {
+        return 1;
+    }
+
+    // Source rows come through a stream so colour is converted as usual
+    sobel_op_stream_t *s = sobel_op_stream_open_frame(op, SOBEL_BLUR_NONE, frame);
+    if (!s) {
+        return 1;
+    }
+
+    pyramid_ctx_t ctx = { .info = s->info, .lines = s->lines, .norm = norm, .levels = pyramid->levels };
+    ctx.slots = 2 * ctx.info->radius + 1;
+
+    // Level 0 rows are read in place (or from the stream's own luma ring), coarser ones are copied
+    size_t ring = 0;
+    for (int l = 1; l < pyramid->levels; l++) {
+        ring += (size_t)ctx.slots * pyramid->cols[l];
+    }
+    uint8_t *mem = malloc(ring + (size_t)pyramid->cols[0] / 2 + 1);
+    if (!mem) {
+        sobel_op_stream_close(s);
+        return 1;
+    }
+
+    uint8_t *next = mem;
+    for (int l = 0; l < pyramid->levels; l++) {
+        ctx.level[l].rows = pyramid->rows[l];
+        ctx.level[l].cols = pyramid->cols[l];
+        ctx.level[l].ring = l > 0 ? next : NULL;
+        ctx.level[l].out = arena + pyramid->offset[l];
+        next += l > 0 ? (size_t)ctx.slots * pyramid->cols[l] : 0;
+    }
+    ctx.half = next;
+
+    for (int r = 0; r < frame->rows; r++) {
+        const uint8_t *row;
+        luma_rows(s, r, 0, &row);
+        pyramid_push(&ctx, 0, row);
+    }
+
+    free(mem);
+    sobel_op_stream_close(s);
+    return 0;
+}
+
+// --- High bit depth ---
+
+// One output row from int32 gradients, either 8-bit or 16-bit, saturated
+static inline __attribute__((always_inline))
+void magnitude_row16(const int32_t *gx, const int32_t *gy, int cols, int shift, int max, sobel_norm_t norm,
+                     uint8_t *restrict out8, uint16_t *restrict out16) {
+    for (int c = 0; c < cols; c++) {
+        int32_t sx = gx[c], sy = gy[c];
+        int32_t magnitude;
+        if (norm == SOBEL_NORM_EUCLIDEAN) {
+            magnitude = (int32_t)(sqrt((double)sx * sx + (double)sy * sy) + 0.5) >> shift;
+        } else {
+            magnitude = ((sx < 0 ? -sx : sx) + (sy < 0 ? -sy : sy)) >> shift;
+        }
+        magnitude = magnitude > max ? max : magnitude;
+        if (out8) {
+            out8[c] = (uint8_t)magnitude;
+        } else {
+            out16[c] = (uint16_t)magnitude;
+        }
+    }
+}
+
+static int op_frame16(sobel_op_t op, const uint16_t *input, int rows, int cols, size_t in_stride, int shift,
+                      uint8_t *out8, uint16_t *out16, size_t out_stride, sobel_norm_t norm) {
+    if (op < 0 || op >= SOBEL_OP_COUNT || !input || rows < 1 || cols < 1) {
+        return 1;
+    }
+
+    const op_info_t *info = &op_table[op];
+    size_t n = (size_t)cols + 2 * OP_MAX_RADIUS;
+    int32_t *mem = malloc(4 * n * sizeof(int32_t));
+    if (!mem) {
+        return 1;
+    }
+
+    op_lines16_t lines = { mem, mem + n, mem + 2 * n, mem + 3 * n };
+    shift += info->gain_shift;
+
+    for (int r = 0; r < rows; r++) {
+        const uint16_t *p[2 * OP_MAX_RADIUS + 1];
+        for (int k = 0; k <= 2 * info->radius; k++) {
+            int y = r + k - info->radius;
+            y = y < 0 ? 0 : (y >= rows ? rows - 1 : y);
+            p[k] = input + (size_t)y * in_stride;
+        }
+
+        info->row16(p, cols, &lines);
+
+        // Separate instantiations keep the norm and output width out of the inner loop
+        if (out8 && norm == SOBEL_NORM_EUCLIDEAN) {
+            magnitude_row16(lines.gx, lines.gy, cols, shift, 255, SOBEL_NORM_EUCLIDEAN, out8 + (size_t)r * out_stride, NULL);
+        } else if (out8) {
+            magnitude_row16(lines.gx, lines.gy, cols, shift, 255, SOBEL_NORM_MANHATTAN, out8 + (size_t)r * out_stride, NULL);
+        } else if (norm == SOBEL_NORM_EUCLIDEAN) {
+            magnitude_row16(lines.gx, lines.gy, cols, shift, 65535, SOBEL_NORM_EUCLIDEAN, NULL, out16 + (size_t)r * out_stride);
+        } else {
+            magnitude_row16(lines.gx, lines.gy, cols, shift, 65535, SOBEL_NORM_MANHATTAN, NULL, out16 + (size_t)r * out_stride);
+        }
+    }
+
+    free(mem);
+    return 0;
+}
+
+int sobel_op_magnitude16(sobel_op_t op, const uint16_t *input, int rows, int cols, size_t in_stride, int bits,
+                         int scale_shift, uint8_t *output, size_t out_stride, sobel_norm_t norm) {
+    if (bits < 8 || bits > 16 || scale_shift < 0 || scale_shift > 2 || !output) {
+        return 1;
+    }
+    return op_frame16(op, input, rows, cols, in_stride, bits - 8 + scale_shift, output, NULL, out_stride, norm);
+}
+
+int sobel_op_magnitude16_wide(sobel_op_t op, const uint16_t *input, int rows, int cols, size_t in_stride,
+                              uint16_t *output, size_t out_stride, sobel_norm_t norm) {
+    return output ? op_frame16(op, input, rows, cols, in_stride, 0, NULL, output, out_stride, norm) : 1;
+}
+
+int sobel_blur(sobel_blur_t blur, const uint8_t *input, int rows, int cols, size_t in_stride,
+               uint8_t *output, size_t out_stride) {
+    const blur_info_t *bi = blur_info(blur);
+
+    if (!bi || !input || !output || rows < 1 || cols < 1) {
+        return 1;
+    }
+
+    uint16_t *line = malloc(((size_t)cols + 2 * OP_MAX_RADIUS) * sizeof(uint16_t));
+    if (!line) {
+        return 1;
+    }
+
+    for (int r = 0; r < rows; r++) {
+        const uint8_t *q[2 * OP_MAX_RADIUS + 1];
+        frame_rows(input, rows, in_stride, r, bi->radius, q);
+        bi->row(q, cols, line, output + (size_t)r * out_stride);
+    }
+
+    free(line);
+    return 0;
+}
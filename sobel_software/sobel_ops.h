@@ -0,0 +1,337 @@
+#ifndef SOBEL_OPS_H
+#define SOBEL_OPS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sobel.h"
+
+// --- Gradient operators ---
+// Every operator is separable: Gx = smooth (vertical) x diff (horizontal), Gy the transpose.
+// Each one is compiled into its own specialised kernel with its coefficients as constants, so
+// zero and unit taps disappear and the row loops vectorise. Borders are clamped as in sobel.c.
+
+typedef enum {
+    SOBEL_OP_SOBEL,         // 3x3, smooth {1, 2, 1},       diff {-1, 0, 1}
+    SOBEL_OP_SCHARR,        // 3x3, smooth {3, 10, 3},      diff {-1, 0, 1}
+    SOBEL_OP_PREWITT,       // 3x3, smooth {1, 1, 1},       diff {-1, 0, 1}
+    SOBEL_OP_SOBEL5,        // 5x5, smooth {1, 4, 6, 4, 1}, diff {-1, -2, 0, 2, 1}
+    SOBEL_OP_COUNT
+} sobel_op_t;
+
+typedef enum {
+    SOBEL_BLUR_NONE = 0,
+    SOBEL_BLUR_3X3 = 3,     // {1, 2, 1} / 4 in both directions
+    SOBEL_BLUR_5X5 = 5      // {1, 4, 6, 4, 1} / 16 in both directions
+} sobel_blur_t;
+
+// --- Input formats ---
+// Colour frames are reduced to luma inside the row pipeline; only the Y plane of YUV is read
+
+typedef enum {
+    SOBEL_PIX_GRAY8,        // 8-bit luma
+    SOBEL_PIX_RGB24,        // interleaved R, G, B
+    SOBEL_PIX_BGR24,        // interleaved B, G, R
+    SOBEL_PIX_I420,         // Y plane, then U and V planes at half resolution
+    SOBEL_PIX_NV12,         // Y plane, then interleaved UV at half resolution
+    SOBEL_PIX_COUNT
+} sobel_pixfmt_t;
+
+typedef struct {
+    const void *data;       // first pixel, the start of the Y plane for YUV
+    int rows;
+    int cols;
+    size_t stride;          // bytes between rows (of the Y plane for YUV)
+    sobel_pixfmt_t format;
+} sobel_frame_t;
+
+/**
+ * Look up a pixel format by name ("gray8", "rgb24", "bgr24", "i420", "nv12")
+ * @param name Format name
+ * @return The format, or SOBEL_PIX_COUNT if the name is unknown
+ */
+sobel_pixfmt_t sobel_pixfmt_from_name(const char *name);
+
+/**
+ * Size of a tightly packed frame
+ * @param format Pixel format
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @return Bytes, including the chroma planes for YUV, or 0 for an unknown format
+ */
+size_t sobel_frame_bytes(sobel_pixfmt_t format, int rows, int cols);
+
+/**
+ * Look up an operator by name ("sobel", "scharr", "prewitt", "sobel5")
+ * @param name Operator name
+ * @return The operator, or SOBEL_OP_COUNT if the name is unknown
+ */
+sobel_op_t sobel_op_from_name(const char *name);
+
+/**
+ * Name of an operator
+ * @param op Operator
+ * @return Its name, or "unknown"
+ */
+const char *sobel_op_name(sobel_op_t op);
+
+/**
+ * Right shift that brings the operator's magnitude to the gain of the 3x3 Sobel
+ * (0 for Sobel and Prewitt, 2 for Scharr, 3 for 5x5 Sobel)
+ * @param op Operator
+ * @return The shift applied by sobel_op_magnitude
+ */
+int sobel_op_gain_shift(sobel_op_t op);
+
+/**
+ * Apply a gradient operator to a frame of any size, saturating the magnitude at 255.
+ * With SOBEL_OP_SOBEL the result is identical to sobel_magnitude.
+ * @param op Operator
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param output First output pixel, rows x cols
+ * @param out_stride Output row stride in pixels
+ * @param norm Magnitude norm, applied before the gain shift
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_op_magnitude(sobel_op_t op, const uint8_t *input, int rows, int cols, size_t in_stride,
+                       uint8_t *output, size_t out_stride, sobel_norm_t norm);
+
+/**
+ * Compute the raw gradients of a gradient operator (no gain shift). They fit int16 for all
+ * operators: at most 1020 for Sobel, 765 for Prewitt, 4080 for Scharr and 12240 for 5x5 Sobel.
+ * @param op Operator
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param gx Horizontal gradient, rows x cols
+ * @param gy Vertical gradient, rows x cols
+ * @param out_stride Gradient row stride in elements
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_op_gradients(sobel_op_t op, const uint8_t *input, int rows, int cols, size_t in_stride,
+                       int16_t *gx, int16_t *gy, size_t out_stride);
+
+/**
+ * Gaussian blur followed by a gradient operator, fused into one pass. Blurred rows are kept in
+ * a rolling buffer of a few lines, so the result equals sobel_blur then sobel_op_magnitude
+ * without the intermediate frame.
+ * @param op Operator
+ * @param blur Gaussian kernel size (SOBEL_BLUR_NONE, SOBEL_BLUR_3X3 or SOBEL_BLUR_5X5)
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param output First output pixel, rows x cols
+ * @param out_stride Output row stride in pixels
+ * @param norm Magnitude norm
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_op_blur_magnitude(sobel_op_t op, sobel_blur_t blur, const uint8_t *input, int rows, int cols,
+                            size_t in_stride, uint8_t *output, size_t out_stride, sobel_norm_t norm);
+
+/**
+ * Same as sobel_op_blur_magnitude for any input format. RGB is converted to BT.601 luma,
+ * Y = (77 R + 150 G + 29 B + 128) >> 8, a few rows at a time as the gradient pass needs them.
+ * @param op Operator
+ * @param blur Gaussian kernel size (SOBEL_BLUR_NONE, SOBEL_BLUR_3X3 or SOBEL_BLUR_5X5)
+ * @param frame Input frame
+ * @param output First output pixel, rows x cols
+ * @param out_stride Output row stride in pixels
+ * @param norm Magnitude norm
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_op_frame_magnitude(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame,
+                             uint8_t *output, size_t out_stride, sobel_norm_t norm);
+
+/**
+ * Same as sobel_op_blur_magnitude, writing the result over the input. Only the input rows the
+ * kernel still needs are kept, in a ring of 2 * radius + 1 rows (3 for the 3x3 operators,
+ * 5 with 5x5 Sobel or blur), so peak memory is the frame plus a few lines. The output is
+ * identical to the out-of-place functions.
+ * @param op Operator
+ * @param blur Gaussian kernel size (SOBEL_BLUR_NONE, SOBEL_BLUR_3X3 or SOBEL_BLUR_5X5)
+ * @param image First pixel, input and output
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param stride Row stride in pixels
+ * @param norm Magnitude norm
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_op_magnitude_inplace(sobel_op_t op, sobel_blur_t blur, uint8_t *image, int rows, int cols,
+                               size_t stride, sobel_norm_t norm);
+
+/**
+ * Gaussian blur of a frame, rounded to nearest, borders clamped
+ * @param blur Gaussian kernel size (SOBEL_BLUR_3X3 or SOBEL_BLUR_5X5)
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param output First output pixel, rows x cols, must not overlap the input
+ * @param out_stride Output row stride in pixels
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_blur(sobel_blur_t blur, const uint8_t *input, int rows, int cols, size_t in_stride,
+               uint8_t *output, size_t out_stride);
+
+// --- Density grid ---
+// A coarse map of where the edges are, for ROI selection: per-cell sums of the magnitude and
+// counts of pixels above a threshold, accumulated while the magnitude rows are produced
+
+typedef struct {
+    int cell;               // cell size in pixels, 1 to 4096; edge cells are clipped to the frame
+    int threshold;          // magnitude counted as an edge from this value
+    uint32_t *sum;          // per-cell magnitude sums, grid rows x grid cols, row-major
+    uint32_t *count;        // per-cell counts of pixels >= threshold, may be NULL
+} sobel_density_t;
+
+/**
+ * Size of the density grid of a frame
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param cell Cell size in pixels
+ * @param grid_rows Grid rows, ceil(rows / cell)
+ * @param grid_cols Grid columns, ceil(cols / cell)
+ * @return 0 on success, 1 on invalid arguments
+ */
+int sobel_density_dims(int rows, int cols, int cell, int *grid_rows, int *grid_cols);
+
+/**
+ * Gradient magnitude with a density grid computed in the same pass (see sobel_op_frame_magnitude)
+ * @param op Operator
+ * @param blur Gaussian kernel size (SOBEL_BLUR_NONE, SOBEL_BLUR_3X3 or SOBEL_BLUR_5X5)
+ * @param frame Input frame
+ * @param output First output pixel, rows x cols, or NULL for the grid only
+ * @param out_stride Output row stride in pixels
+ * @param norm Magnitude norm
+ * @param density Grid parameters and buffers, overwritten
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_op_density(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame, uint8_t *output,
+                     size_t out_stride, sobel_norm_t norm, const sobel_density_t *density);
+
+// --- Pyramid ---
+// Magnitudes at full, 1/2, 1/4 ... resolution from one pass over the source, all levels packed
+// into a single arena
+
+#define SOBEL_PYRAMID_MAX_LEVELS 8
+
+typedef struct {
+    int levels;
+    int rows[SOBEL_PYRAMID_MAX_LEVELS];     // level l is ceil(rows / 2^l) x ceil(cols / 2^l)
+    int cols[SOBEL_PYRAMID_MAX_LEVELS];
+    size_t offset[SOBEL_PYRAMID_MAX_LEVELS];   // start of level l in the arena, rows packed
+    size_t bytes;                           // arena size
+} sobel_pyramid_t;
+
+/**
+ * Lay out the levels of a pyramid in one arena
+ * @param rows Full-resolution rows
+ * @param cols Full-resolution columns
+ * @param levels Number of levels, 1 to SOBEL_PYRAMID_MAX_LEVELS, including the full resolution
+ * @param pyramid Layout, filled in
+ * @return 0 on success, 1 on invalid arguments
+ */
+int sobel_pyramid_layout(int rows, int cols, int levels, sobel_pyramid_t *pyramid);
+
+/**
+ * Gradient magnitude of every pyramid level. Level l + 1 is the 2x2 average of level l, rounded,
+ * and is built from rows of level l as they stream through, never as a separate image. Each
+ * level equals sobel_op_magnitude applied to that downsampled image.
+ * @param op Operator
+ * @param frame Full-resolution input frame, pyramid->rows[0] x pyramid->cols[0]
+ * @param norm Magnitude norm
+ * @param pyramid Layout from sobel_pyramid_layout
+ * @param arena Output, pyramid->bytes
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_op_pyramid(sobel_op_t op, const sobel_frame_t *frame, sobel_norm_t norm,
+                     const sobel_pyramid_t *pyramid, uint8_t *arena);
+
+// --- High bit depth ---
+// uint16 samples from 10, 12 or 16-bit sensors, processed at full precision with 32-bit
+// accumulators: no truncating pass to 8 bits beforehand
+
+/**
+ * Apply a gradient operator to high bit depth input and scale the magnitude to 8 bits.
+ * The magnitude is shifted right by (bits - 8) + scale_shift (on top of the operator gain
+ * shift) and saturated at 255, like the IP core's scaler; with bits = 8 and scale_shift = 0 the
+ * result equals sobel_op_magnitude.
+ * @param op Operator
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param bits Significant bits per sample, 8 to 16
+ * @param scale_shift Extra right shift, 0, 1 or 2 (SOBEL_HW_SCALE_*)
+ * @param output First output pixel, rows x cols
+ * @param out_stride Output row stride in pixels
+ * @param norm Magnitude norm
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_op_magnitude16(sobel_op_t op, const uint16_t *input, int rows, int cols, size_t in_stride, int bits,
+                         int scale_shift, uint8_t *output, size_t out_stride, sobel_norm_t norm);
+
+/**
+ * Apply a gradient operator to high bit depth input, keeping the full-range magnitude. Only the
+ * operator gain shift is applied, and the result saturates at 65535, which is reached only
+ * beyond 13-bit input with the 3x3 Sobel.
+ * @param op Operator
+ * @param input First input pixel
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @param output First output pixel, rows x cols
+ * @param out_stride Output row stride in pixels
+ * @param norm Magnitude norm
+ * @return 0 on success, 1 on invalid arguments or allocation failure
+ */
+int sobel_op_magnitude16_wide(sobel_op_t op, const uint16_t *input, int rows, int cols, size_t in_stride,
+                              uint16_t *output, size_t out_stride, sobel_norm_t norm);
+
+// --- Row streaming ---
+// Gradient rows in frame order, for stages that consume them as they are produced
+
+typedef struct sobel_op_stream sobel_op_stream_t;
+
+/**
+ * Start streaming the gradients of a frame, with optional fused Gaussian blur
+ * @param op Operator
+ * @param blur Gaussian kernel size (SOBEL_BLUR_NONE, SOBEL_BLUR_3X3 or SOBEL_BLUR_5X5)
+ * @param input First input pixel, must stay valid until the stream is closed
+ * @param rows Frame rows
+ * @param cols Frame columns
+ * @param in_stride Input row stride in pixels
+ * @return The stream, or NULL on invalid arguments or allocation failure
+ */
+sobel_op_stream_t *sobel_op_stream_open(sobel_op_t op, sobel_blur_t blur, const uint8_t *input,
+                                        int rows, int cols, size_t in_stride);
+
+/**
+ * Start streaming the gradients of a frame in any input format
+ * @param op Operator
+ * @param blur Gaussian kernel size (SOBEL_BLUR_NONE, SOBEL_BLUR_3X3 or SOBEL_BLUR_5X5)
+ * @param frame Input frame, its data must stay valid until the stream is closed
+ * @return The stream, or NULL on invalid arguments or allocation failure
+ */
+sobel_op_stream_t *sobel_op_stream_open_frame(sobel_op_t op, sobel_blur_t blur, const sobel_frame_t *frame);
+
+/**
+ * Compute the next row of raw gradients (no gain shift)
+ * @param stream Stream
+ * @param gx Horizontal gradient row, cols elements
+ * @param gy Vertical gradient row, cols elements
+ * @return The row index, or -1 after the last row
+ */
+int sobel_op_stream_next(sobel_op_stream_t *stream, int16_t *gx, int16_t *gy);
+
+/**
+ * Release a stream
+ * @param stream Stream, may be NULL
+ */
+void sobel_op_stream_close(sobel_op_stream_t *stream);
+
+#endif // SOBEL_OPS_H
@@ -0,0 +1,237 @@
+#include "sobel_pool.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    // MinGW has neither mmap nor pthreads: the arena is a heap block, the lock a critical section
+    #include <windows.h>
+    #include <malloc.h>
+    typedef CRITICAL_SECTION pool_lock_t;
+    #define pool_lock_init(l)       InitializeCriticalSection(l)
+    #define pool_lock(l)            EnterCriticalSection(l)
+    #define pool_unlock(l)          LeaveCriticalSection(l)
+    #define pool_lock_destroy(l)    DeleteCriticalSection(l)
+#else
+    #include <pthread.h>
+    #include <sys/mman.h>
+    typedef pthread_mutex_t pool_lock_t;
+    #define pool_lock_init(l)       pthread_mutex_init(l, NULL)
+    #define pool_lock(l)            pthread_mutex_lock(l)
+    #define pool_unlock(l)          pthread_mutex_unlock(l)
+    #define pool_lock_destroy(l)    pthread_mutex_destroy(l)
+#endif
+
+#define POOL_PAGE       4096
+#define POOL_HUGE_PAGE  (2u << 20)
+#define POOL_CLASSES    140         // 4 page classes, then 4 per power of two from 16 KB to 2^48
+
+struct sobel_pool {
+    pool_lock_t lock;
+    uint8_t *base;
+    size_t map_bytes;               // mapped, including alignment slack
+    uint8_t *map;
+    sobel_pool_stats_t stats;
+    uint8_t *page_class;            // class + 1 at the first page of every carved buffer
+    void *free_list[POOL_CLASSES];  // freed buffers link through their first bytes
+};
+
+// --- Size classes ---
+
+static int class_index(size_t size, size_t *class_size) {
+    size_t pages = (size + POOL_PAGE - 1) / POOL_PAGE;
+    if (pages == 0) pages = 1;
+
+    if (pages <= 4) {
+        *class_size = pages * POOL_PAGE;
+        return (int)pages - 1;
+    }
+
+    size_t bytes = pages * POOL_PAGE;
+    int k = 63 - __builtin_clzll((unsigned long long)bytes);
+    size_t step = (size_t)1 << (k - 2);
+    size_t quarters = (bytes + step - 1) / step;
+    if (quarters == 8) {
+        k++;
+        step <<= 1;
+        quarters = 4;
+    }
+    if (k >= 48) {
+        return -1;
+    }
+
+    *class_size = quarters * step;
+    return 4 + (k - 14) * 4 + (int)(quarters - 4);
+}
+
+size_t sobel_pool_class_size(size_t size) {
+    size_t class_size;
+    return class_index(size, &class_size) < 0 ? 0 : class_size;
+}
+
+// --- Heap ---
+// Page-aligned blocks for the heap fallback, and for the whole arena where mmap is missing
+
+static void *heap_alloc(size_t bytes) {
+#ifdef _WIN32
+    return _aligned_malloc(bytes, POOL_PAGE);
+#else
+    void *block;
+    return posix_memalign(&block, POOL_PAGE, bytes) == 0 ? block : NULL;
+#endif
+}
+
+static void heap_free(void *block) {
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    free(block);
+#endif
+}
+
+// --- Arena ---
+
+// Huge pages are tried as reserved pages first, then as transparent ones on a 2 MB aligned range
+static int map_arena(sobel_pool_t *pool, size_t bytes, int flags) {
+#ifdef _WIN32
+    (void)flags;
+    bytes = (bytes + POOL_PAGE - 1) / POOL_PAGE * POOL_PAGE;
+    pool->map = pool->base = heap_alloc(bytes);
+    if (!pool->map) {
+        return 1;
+    }
+    pool->map_bytes = pool->stats.arena = bytes;
+    pool->stats.pages = SOBEL_PAGES_NORMAL;
+    return 0;
+#else
+    int huge = flags & SOBEL_POOL_HUGE_PAGES;
+    size_t align = huge ? POOL_HUGE_PAGE : POOL_PAGE;
+    bytes = (bytes + align - 1) / align * align;
+
+#ifdef MAP_HUGETLB
+    if (huge) {
+        void *map = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (map != MAP_FAILED) {
+            pool->map = pool->base = map;
+            pool->map_bytes = pool->stats.arena = bytes;
+            pool->stats.pages = SOBEL_PAGES_HUGETLB;
+            return 0;
+        }
+    }
+#endif
+
+    size_t map_bytes = bytes + (huge ? POOL_HUGE_PAGE : 0);
+    void *map = mmap(NULL, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        return 1;
+    }
+
+    pool->map = map;
+    pool->map_bytes = map_bytes;
+    pool->base = (uint8_t *)(((uintptr_t)map + align - 1) & ~(uintptr_t)(align - 1));
+    pool->stats.arena = bytes;
+    pool->stats.pages = SOBEL_PAGES_NORMAL;
+#ifdef MADV_HUGEPAGE
+    if (huge && madvise(pool->base, bytes, MADV_HUGEPAGE) == 0) {
+        pool->stats.pages = SOBEL_PAGES_TRANSPARENT;
+    }
+#endif
+    return 0;
+#endif
+}
+
+static void unmap_arena(sobel_pool_t *pool) {
+#ifdef _WIN32
+    heap_free(pool->map);
+#else
+    munmap(pool->map, pool->map_bytes);
+#endif
+}
+
+sobel_pool_t *sobel_pool_create(size_t arena_bytes, int flags) {
+    sobel_pool_t *pool = calloc(1, sizeof(*pool));
+    if (!pool) {
+        return NULL;
+    }
+
+    if (map_arena(pool, arena_bytes ? arena_bytes : POOL_PAGE, flags) != 0) {
+        free(pool);
+        return NULL;
+    }
+
+    pool->page_class = calloc(pool->stats.arena / POOL_PAGE, 1);
+    if (!pool->page_class) {
+        unmap_arena(pool);
+        free(pool);
+        return NULL;
+    }
+
+    // Pre-fault with a write per page so no frame pays for first-touch faults
+    for (size_t offset = 0; offset < pool->stats.arena; offset += POOL_PAGE) {
+        pool->base[offset] = 0;
+    }
+
+    pool_lock_init(&pool->lock);
+    return pool;
+}
+
+// --- Buffers ---
+
+void *sobel_pool_alloc(sobel_pool_t *pool, size_t size) {
+    size_t class_size;
+    int c = class_index(size, &class_size);
+    if (c < 0) {
+        return NULL;
+    }
+
+    void *buffer = NULL;
+    pool_lock(&pool->lock);
+    if (pool->free_list[c]) {
+        buffer = pool->free_list[c];
+        memcpy(&pool->free_list[c], buffer, sizeof(void *));
+        pool->stats.reused++;
+    } else if (pool->stats.arena - pool->stats.carved >= class_size) {
+        buffer = pool->base + pool->stats.carved;
+        pool->page_class[pool->stats.carved / POOL_PAGE] = (uint8_t)(c + 1);
+        pool->stats.carved += class_size;
+    } else {
+        pool->stats.heap++;
+    }
+    pool_unlock(&pool->lock);
+
+    return buffer ? buffer : heap_alloc(class_size);
+}
+
+void sobel_pool_free(sobel_pool_t *pool, void *buffer) {
+    uint8_t *p = buffer;
+    if (!p) {
+        return;
+    }
+
+    if (p < pool->base || p >= pool->base + pool->stats.arena) {
+        heap_free(p);
+        return;
+    }
+
+    int c = pool->page_class[(size_t)(p - pool->base) / POOL_PAGE] - 1;
+    pool_lock(&pool->lock);
+    memcpy(p, &pool->free_list[c], sizeof(void *));
+    pool->free_list[c] = p;
+    pool_unlock(&pool->lock);
+}
+
+void sobel_pool_stats(sobel_pool_t *pool, sobel_pool_stats_t *stats) {
+    pool_lock(&pool->lock);
+    *stats = pool->stats;
+    pool_unlock(&pool->lock);
+}
+
+void sobel_pool_destroy(sobel_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+
+    pool_lock_destroy(&pool->lock);
+    unmap_arena(pool);
+    free(pool->page_class);
+    free(pool);
+}
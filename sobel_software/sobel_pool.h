@@ -0,0 +1,76 @@
+#ifndef SOBEL_POOL_H
+#define SOBEL_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Frame buffer pool ---
+// One arena mapped and pre-faulted up front, optionally on 2 MB pages, carved into page-aligned
+// frame buffers. Sizes are rounded up to classes (whole pages up to 16 KB, then four steps per
+// power of two, at most 25% slack) and freed buffers wait on a list per class, so a batch of
+// frames of the same size recycles the same memory without touching the allocator or taking a
+// page fault. Requests the arena cannot hold fall back to the heap. Thread safe. Without mmap
+// (Windows builds) the arena is one page-aligned heap block on normal pages.
+
+typedef struct sobel_pool sobel_pool_t;
+
+#define SOBEL_POOL_HUGE_PAGES 1     // back the arena with 2 MB pages when the system allows it
+
+typedef enum {
+    SOBEL_PAGES_NORMAL,
+    SOBEL_PAGES_TRANSPARENT,        // madvise(MADV_HUGEPAGE), the kernel may still split them
+    SOBEL_PAGES_HUGETLB             // MAP_HUGETLB, reserved huge pages
+} sobel_pages_t;
+
+typedef struct {
+    size_t arena;                   // arena bytes
+    size_t carved;                  // arena bytes handed out at least once
+    long reused;                    // allocations served from a free list
+    long heap;                      // allocations the arena could not hold
+    sobel_pages_t pages;
+} sobel_pool_stats_t;
+
+/**
+ * Bytes a buffer of the given size occupies in the pool, to size arenas
+ * @param size Requested bytes
+ * @return Size of its class, or 0 if too large
+ */
+size_t sobel_pool_class_size(size_t size);
+
+/**
+ * Map and pre-fault an arena
+ * @param arena_bytes Arena size, rounded up to whole (huge) pages
+ * @param flags 0 or SOBEL_POOL_HUGE_PAGES
+ * @return The pool, or NULL on failure
+ */
+sobel_pool_t *sobel_pool_create(size_t arena_bytes, int flags);
+
+/**
+ * Take a buffer
+ * @param pool Pool
+ * @param size Bytes needed
+ * @return A page-aligned buffer, or NULL on failure
+ */
+void *sobel_pool_alloc(sobel_pool_t *pool, size_t size);
+
+/**
+ * Return a buffer to its class
+ * @param pool Pool
+ * @param buffer Buffer from sobel_pool_alloc, may be NULL
+ */
+void sobel_pool_free(sobel_pool_t *pool, void *buffer);
+
+/**
+ * Usage counters
+ * @param pool Pool
+ * @param stats Filled with the counters
+ */
+void sobel_pool_stats(sobel_pool_t *pool, sobel_pool_stats_t *stats);
+
+/**
+ * Unmap the arena; buffers from the heap fallback must have been freed
+ * @param pool Pool, may be NULL
+ */
+void sobel_pool_destroy(sobel_pool_t *pool);
+
+#endif // SOBEL_POOL_H
@@ -0,0 +1,173 @@
+#include "sobel_sched.h"
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <time.h>
+#include <pthread.h>
+#include "timer.h"
+
+#define SCHED_SPINS 64          // empty steal rounds before an idle worker starts sleeping
+
+typedef struct {
+    pthread_mutex_t lock;
+    sobel_task_t *tasks;        // ring of cap entries, live range [top, bottom)
+    long cap;
+    long top;                   // oldest, taken by thieves
+    long bottom;                // newest, taken by the owner
+    long steals;
+    long run;
+    double busy;
+} sched_deque_t;
+
+struct sobel_sched {
+    sched_deque_t *deques;
+    int workers;
+    long pending;               // queued or running tasks
+    sobel_task_fn fn;
+    void *ctx;
+};
+
+typedef struct {
+    sobel_sched_t *sched;
+    int worker;
+} sched_worker_t;
+
+// --- Deques ---
+
+static int deque_push(sched_deque_t *d, const sobel_task_t *task) {
+    if (d->bottom - d->top == d->cap) {
+        long cap = d->cap ? 2 * d->cap : 64;
+        sobel_task_t *tasks = malloc(cap * sizeof(sobel_task_t));
+        if (!tasks) {
+            return 1;
+        }
+        for (long i = d->top; i < d->bottom; i++) {
+            tasks[i % cap] = d->tasks[i % d->cap];
+        }
+        free(d->tasks);
+        d->tasks = tasks;
+        d->cap = cap;
+    }
+    d->tasks[d->bottom++ % d->cap] = *task;
+    return 0;
+}
+
+static int deque_take(sched_deque_t *d, sobel_task_t *task, int own) {
+    pthread_mutex_lock(&d->lock);
+    int found = d->bottom > d->top;
+    if (found) {
+        *task = own ? d->tasks[--d->bottom % d->cap] : d->tasks[d->top++ % d->cap];
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+// --- Workers ---
+
+static void *sched_worker(void *arg) {
+    const sched_worker_t *w = arg;
+    sobel_sched_t *s = w->sched;
+    sched_deque_t *own = &s->deques[w->worker];
+    int idle = 0;
+
+    for (;;) {
+        sobel_task_t task;
+        int found = deque_take(own, &task, 1);
+
+        // Steal from the next workers in turn so thieves spread over different victims
+        for (int v = 1; !found && v < s->workers; v++) {
+            found = deque_take(&s->deques[(w->worker + v) % s->workers], &task, 0);
+            if (found) own->steals++;
+        }
+
+        if (!found) {
+            if (__atomic_load_n(&s->pending, __ATOMIC_ACQUIRE) == 0) {
+                return NULL;
+            }
+            // Running tasks may still spawn work: spin briefly, then back off
+            if (++idle < SCHED_SPINS) {
+                sched_yield();
+            } else {
+                struct timespec pause = { 0, 50000 };
+                nanosleep(&pause, NULL);
+            }
+            continue;
+        }
+
+        idle = 0;
+        double start_time = get_current_time();
+        s->fn(s, w->worker, &task, s->ctx);
+        own->busy += get_elapsed_time(start_time);
+        own->run++;
+        __atomic_sub_fetch(&s->pending, 1, __ATOMIC_RELEASE);
+    }
+}
+
+int sobel_sched_push(sobel_sched_t *sched, int worker, const sobel_task_t *task) {
+    sched_deque_t *d = &sched->deques[worker];
+
+    __atomic_add_fetch(&sched->pending, 1, __ATOMIC_RELAXED);
+    pthread_mutex_lock(&d->lock);
+    int result = deque_push(d, task);
+    pthread_mutex_unlock(&d->lock);
+
+    if (result) {
+        __atomic_sub_fetch(&sched->pending, 1, __ATOMIC_RELAXED);
+    }
+    return result;
+}
+
+int sobel_sched_run(int workers, const sobel_task_t *tasks, int count, sobel_task_fn fn, void *ctx,
+                    sobel_sched_stats_t *stats) {
+    if (workers < 1) workers = 1;
+
+    sobel_sched_t sched = { .workers = workers, .pending = count, .fn = fn, .ctx = ctx };
+    sched.deques = calloc(workers, sizeof(sched_deque_t));
+    sched_worker_t *args = malloc(workers * sizeof(sched_worker_t));
+    pthread_t *tids = malloc(workers * sizeof(pthread_t));
+    int result = !sched.deques || !args || !tids;
+
+    for (int w = 0; sched.deques && w < workers; w++) {
+        pthread_mutex_init(&sched.deques[w].lock, NULL);
+    }
+    for (int w = 0; args && w < workers; w++) {
+        args[w].sched = &sched;
+        args[w].worker = w;
+    }
+    for (int t = 0; t < count && !result; t++) {
+        result = deque_push(&sched.deques[t % workers], &tasks[t]);
+    }
+
+    if (!result) {
+        double start_time = get_current_time();
+
+        // Workers that fail to start leave their deques to be stolen from
+        int started = 1;
+        while (started < workers && pthread_create(&tids[started], NULL, sched_worker, &args[started]) == 0) {
+            started++;
+        }
+        sched_worker(&args[0]);
+        for (int t = 1; t < started; t++) {
+            pthread_join(tids[t], NULL);
+        }
+
+        if (stats) {
+            memset(stats, 0, sizeof(*stats));
+            stats->wall = get_elapsed_time(start_time);
+            for (int w = 0; w < workers; w++) {
+                stats->tasks += sched.deques[w].run;
+                stats->steals += sched.deques[w].steals;
+                stats->busy += sched.deques[w].busy;
+            }
+        }
+    }
+
+    for (int w = 0; sched.deques && w < workers; w++) {
+        pthread_mutex_destroy(&sched.deques[w].lock);
+        free(sched.deques[w].tasks);
+    }
+    free(sched.deques);
+    free(args);
+    free(tids);
+    return result;
+}
@@ -0,0 +1,56 @@
+#ifndef SOBEL_SCHED_H
+#define SOBEL_SCHED_H
+
+// --- Work-stealing scheduler ---
+// One deque of tasks per worker. A worker pops its own newest task and, when it runs dry, steals
+// the oldest task of another worker, so work spawned by a task (the tiles of a frame) stays on the
+// core that loaded its data while idle cores take whatever is left anywhere. Tasks may push more
+// tasks; the run ends when every deque is empty and no task is running.
+
+typedef struct sobel_sched sobel_sched_t;
+
+typedef struct {
+    void *data;
+    long begin;
+    long end;
+} sobel_task_t;
+
+typedef struct {
+    long tasks;                 // tasks run
+    long steals;                // tasks taken from another worker's deque
+    double busy;                // seconds spent in tasks, summed over workers
+    double wall;                // seconds from start to the last task
+} sobel_sched_stats_t;
+
+/**
+ * Task body
+ * @param sched Scheduler, for sobel_sched_push
+ * @param worker Index of the running worker
+ * @param task Task to run
+ * @param ctx As passed to sobel_sched_run
+ */
+typedef void (*sobel_task_fn)(sobel_sched_t *sched, int worker, const sobel_task_t *task, void *ctx);
+
+/**
+ * Run tasks to completion on a pool of workers, the caller being worker 0
+ * @param workers Worker count, 1 runs everything on the caller
+ * @param tasks Initial tasks, dealt round-robin; each worker starts with the last one it was dealt
+ * @param count Number of initial tasks
+ * @param fn Task body
+ * @param ctx Passed to every task
+ * @param stats Filled with counters, may be NULL
+ * @return 0 on success, 1 on allocation failure (no task was run)
+ */
+int sobel_sched_run(int workers, const sobel_task_t *tasks, int count, sobel_task_fn fn, void *ctx,
+                    sobel_sched_stats_t *stats);
+
+/**
+ * Queue a task on a worker's own deque, from inside a task
+ * @param sched Scheduler
+ * @param worker Index of the running worker
+ * @param task Task to queue
+ * @return 0 on success, 1 on allocation failure
+ */
+int sobel_sched_push(sobel_sched_t *sched, int worker, const sobel_task_t *task);
+
+#endif // SOBEL_SCHED_H
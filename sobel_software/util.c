@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include "sobel_constants.h"
 
 void print_matrix(const int *matrix, int rows, int cols) {
@@ -25,6 +26,27 @@ int load_raw_image(const char *filename, uint8_t image[ROW][COLUMN]) {
     return result;
 }
 
+long raw_file_size(const char *filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) return -1;
+
+    long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    fclose(file);
+    return size;
+}
+
+int load_raw_frame(const char *filename, uint8_t *buffer, size_t size) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        perror("[ERROR] Opening input file");
+        return 1;
+    }
+
+    int result = fread(buffer, 1, size, file) == size ? 0 : 1;
+    fclose(file);
+    return result;
+}
+
 int load_csv_image(FILE *file, uint8_t image[ROW][COLUMN]) {
     if (!file) return 1;
     
@@ -64,4 +86,19 @@ int save_csv_image(FILE *file, uint8_t image[ROW][COLUMN]) {
         }
     }
     return 0;
+}
+
+int parse_image_dims(const char *path, int *rows, int *cols) {
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+
+    for (const char *p = strchr(base, '_'); p; p = strchr(p + 1, '_')) {
+        int w, h, n = 0;
+        if (sscanf(p, "_%d_%d%n", &w, &h, &n) == 2 && (p[n] == '_' || p[n] == '.' || p[n] == '\0')) {
+            *cols = w;
+            *rows = h;
+            return 0;
+        }
+    }
+    return 1;
 }
\ No newline at end of file
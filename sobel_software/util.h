@@ -45,4 +45,29 @@ int save_raw_image(const char *filename, uint8_t image[ROW][COLUMN]);
  */
 int save_csv_image(FILE *file, uint8_t image[ROW][COLUMN]);
 
+/**
+ * Size of a file
+ * @param filename Path to the file
+ * @return Size in bytes, or -1 if it cannot be read
+ */
+long raw_file_size(const char *filename);
+
+/**
+ * Load a raw frame of any layout from file
+ * @param filename Path to input file
+ * @param buffer Output buffer
+ * @param size Bytes to read
+ * @return 0 on success, 1 on error
+ */
+int load_raw_frame(const char *filename, uint8_t *buffer, size_t size);
+
+/**
+ * Parse the frame size from file names like lena_512_512_raw (<name>_<cols>_<rows>...)
+ * @param path File path, only the base name is looked at
+ * @param rows Parsed number of rows
+ * @param cols Parsed number of columns
+ * @return 0 on success, 1 if the name carries no size
+ */
+int parse_image_dims(const char *path, int *rows, int *cols);
+
 #endif // UTIL_H
\ No newline at end of file